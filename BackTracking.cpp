@@ -1,220 +1,580 @@
-#include <QRandomGenerator64>
 #include "BackTracking.h"
 #include "Game.h"
-#include <QtGlobal>
-#include <fstream>
+#include "SearchTrace.h"
+#include "OpeningBook.h"
+#include "Tablebase.h"
 #include <string>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
 
-std::pair<int, std::pair<char, char>> findBestJumpMoveAI(const std::map<std::pair<char, char>, char> &gameBoard,
-                                                         const std::pair<char, char> &from){
+//Picks the capture sequence from the square that takes the most tokens, at random between equal ones.
+//Returns the number of tokens taken and the landing square.
+std::pair<int, int> findBestJumpMoveAI(const Position & position,
+                                       const int & from){
 
-    std::set<std::pair<char, char>> possibilities {}; //squares that need to be searched
-    std::set<std::pair<char, char>> searchedPossibilities{}; //squares that were already searched through
-
-    int playerPiece = gameBoard.at(from);
-
-    //Structure that contains a position, the possibilities for the next step and if the enemy has been there
-    struct Node {
-    public:
-        std::pair<char, char> square; //Which square this is
-        std::stack<std::pair<char, char>> jumpPoints; //Where this node can jump to
-        std::pair<char, char> jumpedOver = { 0,0 }; //What enemy token this node has jumped over
-        bool searched = false;
-        std::shared_ptr<Node> fromPtr = nullptr;
-        Node(std::pair<char, char> square, std::shared_ptr<Node> fromPtr, std::pair<char, char> jumpedOver) {
-            this->square = square;
-            this->fromPtr = fromPtr;
-            this->jumpedOver = jumpedOver;
-        }
-        Node(std::pair<char, char> x) {
-            square = x;
-        }
-        Node() {
+    MoveList captures;
+    generateCaptures(position, from, captures);
 
+    int val = 0;
+    for (int i = 0; i < captures.size; i++)
+        val = std::max(val, int(captures[i].jumps));
+
+    int to = from;
+    if (val > 0) {
+        int best[MAX_MOVES];
+        int bestCount = 0;
+        for (int i = 0; i < captures.size; i++) {
+            if (captures[i].jumps == val)
+                best[bestCount++] = captures[i].to;
         }
-    };
+        to = best[rand() % bestCount];
+    }
 
-    Node current (from);//Create a new node
-    possibilities.insert(from);//Insert a square in possibilities
+    return { val, to };
+}
+std::pair<int, std::pair<char, char>> findBestJumpMoveAI(const std::map<std::pair<char, char>, char> &gameBoard,
+                                                         const std::pair<char, char> &from){
+    auto result = findBestJumpMoveAI(toPosition(gameBoard), squareIndex(from));
+    return { result.first, squareName(result.second) };
+}
 
-    int jumpedPieceAmount = 0;
-    std::map<int, std::vector<std::pair<char, char>>> valueOfSquare{}; //Stores squares based on how many enemies they have jumped over.
-    valueOfSquare[0].push_back(from);
+int findSingleSquareMoveAI(const Position & position,
+                           const int & from) {
 
-    while (possibilities != searchedPossibilities) {
-        auto temp = findJumpSquares(playerPiece, current.square, gameBoard);
+    std::vector<int> possibleMoves {};
+    const uint32_t fromMask = squareMask(from);
+    const uint32_t empty = ~(position.black | position.white);
+    char playerPiece = pieceAt(position, from);
 
-        if (!current.searched) {
-            for (unsigned int i = 0; i < temp.first.size(); i++) {
-                auto el = temp.first.at(i);
-                current.jumpPoints.push(el);
-                possibilities.insert(el);
-            }
-            current.searched = true;
-        }
-        if (!current.jumpPoints.empty()) {
-            auto top = current.jumpPoints.top();
-
-            //Cycles through 'tops' that have already been searched
-            while (searchedPossibilities.find(top) != searchedPossibilities.end()) {
-                if (!current.jumpPoints.empty()) //avoid crash
-                    current.jumpPoints.pop();
-
-                if (current.jumpPoints.empty()) //avoid crash
-                    break;
-                else
-                    top = current.jumpPoints.top();
-            }
-        }
-        if (current.jumpPoints.empty()) { //Check if end of the line
-            if (current.fromPtr == nullptr) {//Avoid end
-                break;
-            }
-            else {
-                valueOfSquare[jumpedPieceAmount].push_back(current.square);
-                current = *(current.fromPtr); //return, at end of the line
-                jumpedPieceAmount--;
-            }
-        }
-        else {
-            auto top = current.jumpPoints.top();
-            current.jumpPoints.pop();
-            searchedPossibilities.insert(current.square);
-            current = Node(top, std::make_shared<Node>(current), temp.second.at(current.jumpPoints.size()/*-1 todo */)); //search down the branch
-            jumpedPieceAmount++;
-        }
+    uint32_t targets = 0;
+    if (playerPiece == pieces[Black] || playerPiece == pieces[BlackKing] || playerPiece == pieces[WhiteKing]) //Pieces that can move up
+        targets |= shiftUpRight(fromMask) | shiftUpLeft(fromMask);
+    if (playerPiece == pieces[White] || playerPiece == pieces[BlackKing] || playerPiece == pieces[WhiteKing]) //Pieces that can move down
+        targets |= shiftDownRight(fromMask) | shiftDownLeft(fromMask);
 
-    }
+    for (uint32_t remaining = targets & empty; remaining; remaining &= remaining - 1)
+        possibleMoves.push_back(lowestSquare(remaining));
 
-    std::pair<char, char> to = from;
-    int val = 0;
-    for (auto it = valueOfSquare.begin(); it != valueOfSquare.end(); ++it){
-        if (it->first > val){
-            val = it->first;
-            int randomIndex = rand() % it->second.size();
-            to = it->second.at(randomIndex);
-        }
+    if(possibleMoves.size() == 0){
+        return -1;
+    }else{
+        int randomIndex = rand() % possibleMoves.size();
+        return possibleMoves.at(randomIndex);
     }
+}
+std::pair<char, char> findSingleSquareMoveAI(const std::map<std::pair<char, char>, char> & gameBoard,
+                                             const std::pair<char, char> & from) {
+    int to = findSingleSquareMoveAI(toPosition(gameBoard), squareIndex(from));
+    return (to < 0) ? std::make_pair('z', 'z') : squareName(to);
+}
+
+static SearchLimits searchLimits;
+static TranspositionTable transpositionTable;
+
+TranspositionTable & sharedTranspositionTable(){
+    return transpositionTable;
+}
+
+void setSearchLimits(const SearchLimits & limits){
+    searchLimits = limits;
+}
+SearchLimits getSearchLimits(){
+    return searchLimits;
+}
+
+//State shared by every thread working on one search
+struct SearchShared {
+    SearchLimits limits;
+    TranspositionTable * table = nullptr;
+    const EvalWeights * weights = nullptr;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> nodes{0}; //all threads, topped up every 1024 nodes for the node budget
 
-    ofstream text;
+    //Main thread only: whether the search is still pondering, and the time and nodes when it stopped
+    bool pondering = false;
+    int limitsStartMs = 0;
+    uint64_t limitsStartNodes = 0;
+};
 
-    text.open("RegistroJump.txt",ios::out);
+//Everything one search thread needs to keep track of while it walks the tree
+struct SearchState {
+    SearchShared * shared = nullptr;
+    int threadIndex = 0; //0 is the main thread, whose result is used
+    SearchStats stats; //this thread's counters
+    uint64_t visited = 0; //alpha-beta and quiescence nodes, for checking the limits every 1024
+    bool stopped = false;
+
+    Position board; //the position being searched, walked with makeMove and unmakeMove
+    UndoStack undo; //the moves made from the root to reach it
+
+    Move pvTable[MAX_PLY][MAX_PLY]; //pvTable[ply] is the best line found from that ply
+    int pvLength[MAX_PLY];
+
+    //Move ordering
+    Move killers[MAX_PLY][2] = {}; //the last two quiet moves that caused a beta cutoff at each ply
+    int history[32][32] = {}; //butterfly table: how often and how deep each quiet from/to caused a cutoff
+};
+
+//Move ordering scores: the TT move, then captures by tokens taken, then killers, then history
+static const int ORDER_TT_MOVE = 1 << 30;
+static const int ORDER_CAPTURE = 1 << 24; //plus the number of tokens taken
+static const int ORDER_KILLER = 1 << 22; //the first killer gets one more than the second
+static const int HISTORY_LIMIT = 1 << 20; //history is halved when it reaches this, so it stays below the killers
+
+//Win scores are stored relative to the position rather than the root, so they stay right when reached at another ply
+static int scoreToTable(const int & score, const int & ply){
+    if (score >= WIN_SCORE - MAX_PLY)
+        return score + ply;
+    if (score <= -WIN_SCORE + MAX_PLY)
+        return score - ply;
+    return score;
+}
+static int scoreFromTable(const int & score, const int & ply){
+    if (score >= WIN_SCORE - MAX_PLY)
+        return score - ply;
+    if (score <= -WIN_SCORE + MAX_PLY)
+        return score + ply;
+    return score;
+}
 
-    for (std::vector<int>::iterator it = possibilities.begin() ; it != possibilities.end(); ++it){
-        std::string str(it.begin(), it.end());
-        text.write(str.c_str(), str.size());
+static int elapsedMs(const SearchShared & shared){
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - shared.start).count());
+}
+//True while the search ponders. When the ponder flag is cleared the limits start counting from that moment.
+static bool pondering(SearchShared & shared, const uint64_t & totalNodes){
+    if (shared.pondering && !shared.limits.ponder->load(std::memory_order_relaxed)) {
+        shared.pondering = false;
+        shared.limitsStartMs = elapsedMs(shared);
+        shared.limitsStartNodes = totalNodes;
+    }
+    return shared.pondering;
+}
+//Called every 1024 nodes. The main thread stops every thread once the time or node budget has run out.
+static void checkLimits(SearchState & state){
+    SearchShared & shared = *state.shared;
+    const uint64_t totalNodes = shared.nodes.fetch_add(1024, std::memory_order_relaxed) + 1024;
+    if (state.threadIndex == 0 && !pondering(shared, totalNodes)) {
+        if ((shared.limits.maxNodes > 0 && totalNodes - shared.limitsStartNodes >= shared.limits.maxNodes)
+                || (shared.limits.timeMs > 0 && elapsedMs(shared) - shared.limitsStartMs >= shared.limits.timeMs))
+            shared.stop.store(true, std::memory_order_relaxed);
     }
-    text.close
+    if (shared.limits.stop != nullptr && shared.limits.stop->load(std::memory_order_relaxed))
+        shared.stop.store(true, std::memory_order_relaxed);
+    if (shared.stop.load(std::memory_order_relaxed))
+        state.stopped = true;
+}
 
-    if(val == 0){
-        return {0, to};
+//The move at this ply followed by the child's best line is the new principal variation
+static void updatePv(SearchState & state, const int & ply, const Move & move){
+    state.pvTable[ply][ply] = move;
+    for (int next = ply + 1; next < state.pvLength[ply + 1]; next++)
+        state.pvTable[ply][next] = state.pvTable[ply + 1][next];
+    state.pvLength[ply] = state.pvLength[ply + 1];
+}
+
+//Score of a position the endgame tablebases settle. A win adds the evaluation so the search heads for simpler wins.
+static bool probeScore(SearchState & state, const Position & position, const int & side, const int & ply, int & score){
+    if (bitCount(position.black | position.white) > tablebasePieces())
+        return false;
+    const int value = probeTablebase(position, side);
+    if (value == TBUnknown)
+        return false;
+    state.stats.tbHits++;
+    if (value == TBDraw) {
+        score = 0;
+        return true;
     }
-    else
-        return { val, to };
+    const int evaluation = evaluate(position, side, *state.shared->weights);
+    score = (value == TBWin) ? TB_WIN_SCORE + evaluation - ply : -TB_WIN_SCORE + evaluation + ply;
+    return true;
 }
 
-std::pair<char, char> findSingleSquareMoveAI(const std::map<std::pair<char, char>, char> & gameBoard,
-                                             const std::pair<char, char> & from) {
+static bool sameMove(const Move & a, const Move & b){
+    return a.from == b.from && a.to == b.to && a.jumps == b.jumps && a.captured == b.captured;
+}
+//Fills 'order' with the indices of the moves, best first. ttIndex is the generateMoves index the transposition
+//table gave as best, -1 if there was none.
+static void orderMoves(const SearchState & state, const MoveList & moveList, const int & ply, const int & ttIndex, int * order){
+    int scores[MAX_MOVES];
+    for (int i = 0; i < moveList.size; i++) {
+        const Move & move = moveList[i];
+        order[i] = i;
+        if (i == ttIndex)
+            scores[i] = ORDER_TT_MOVE;
+        else if (move.jumps > 0)
+            scores[i] = ORDER_CAPTURE + move.jumps;
+        else if (sameMove(move, state.killers[ply][0]))
+            scores[i] = ORDER_KILLER + 1;
+        else if (sameMove(move, state.killers[ply][1]))
+            scores[i] = ORDER_KILLER;
+        else
+            scores[i] = state.history[move.from][move.to];
+    }
+    //insertion sort, the lists are short
+    for (int i = 1; i < moveList.size; i++) {
+        const int index = order[i];
+        int j = i;
+        for (; j > 0 && scores[order[j - 1]] < scores[index]; j--)
+            order[j] = order[j - 1];
+        order[j] = index;
+    }
+}
+//Remembers a quiet move that caused a beta cutoff
+static void updateOrdering(SearchState & state, const Move & move, const int & ply, const int & depth){
+    if (move.jumps > 0)
+        return; //captures are forced and already ordered first
+    if (!sameMove(move, state.killers[ply][0])) {
+        state.killers[ply][1] = state.killers[ply][0];
+        state.killers[ply][0] = move;
+    }
+    int & history = state.history[move.from][move.to];
+    history += depth * depth;
+    if (history >= HISTORY_LIMIT) {
+        for (auto & from : state.history)
+            for (auto & to : from)
+                to /= 2;
+    }
+}
 
-    std::vector<std::pair<char, char>> possibleMoves {};
-    char playerPiece = gameBoard.find(from)->second;
-    auto it = gameBoard.find(std::make_pair(from.first + 1, from.second + 1));
+//Quiescence search past the horizon. Captures are forced, so while the side to move has one the capture
+//sequences are played out and the best of them is the score. Once it has none the position is quiet and the
+//side stands pat on the evaluation. quiescencePlies bounds how far past the horizon this goes.
+static int quiescence(SearchState & state, Position & position, const int & side,
+                      const int & ply, const int & quiescencePly, int alpha, const int & beta){
+    state.pvLength[ply] = ply;
+    state.stats.qnodes++;
+    if ((++state.visited & 1023) == 0)
+        checkLimits(state);
+    if (state.stopped)
+        return 0;
 
-    if (playerPiece == pieces[Black] || playerPiece == pieces[BlackKing]) { //Pieces that can move up
-        //top right square
-        it = gameBoard.find(std::make_pair(from.first + 1, from.second + 1));
-        if(it != gameBoard.end()){
-            if(it->second == pieces[Empty]){ //if the square is empty
-                possibleMoves.push_back(it->first);
-            }
-        }
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+    if (moveList.overflowed)
+        state.stats.moveListOverflows++;
+    if (moveList.size == 0)
+        return -WIN_SCORE + ply;
+    int tablebaseScore = 0;
+    if (probeScore(state, position, side, ply, tablebaseScore))
+        return tablebaseScore;
+    if (moveList[0].jumps == 0 || quiescencePly >= state.shared->limits.quiescencePlies || ply >= MAX_PLY - 1)
+        return evaluate(position, side, *state.shared->weights); //stand pat
 
-        //top left square
-        it = gameBoard.find(std::make_pair(from.first - 1, from.second + 1));
-        if(it != gameBoard.end()){
-            if(it->second == pieces[Empty]){ //if the square is empty
-                possibleMoves.push_back(it->first);
+    int order[MAX_MOVES];
+    orderMoves(state, moveList, ply, -1, order);
+    const int enemy = (side == Black) ? White : Black;
+    int bestScore = -WIN_SCORE;
+    for (int n = 0; n < moveList.size; n++) {
+        const int i = order[n];
+        makeMove(position, moveList[i], state.undo);
+        int score = -quiescence(state, position, enemy, ply + 1, quiescencePly + 1, -beta, -alpha);
+        unmakeMove(position, state.undo);
+        if (state.stopped)
+            return 0;
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(state, ply, moveList[i]);
             }
+            if (alpha >= beta)
+                break;
         }
+    }
+    return bestScore;
+}
+
+//Negamax alpha-beta. Returns the score of the position for the side to move.
+static int alphaBeta(SearchState & state, Position & position, const int & side,
+                     int depth, const int & ply, int alpha, const int & beta){
+    if (depth <= 0)
+        return quiescence(state, position, side, ply, 0, alpha, beta);
+    state.pvLength[ply] = ply;
+    state.stats.nodes++;
+    if ((++state.visited & 1023) == 0)
+        checkLimits(state);
+    if (state.stopped)
+        return 0;
 
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+    if (moveList.overflowed)
+        state.stats.moveListOverflows++;
+    if (moveList.size == 0)
+        return -WIN_SCORE + ply; //no moves left, this side has lost
+    int tablebaseScore = 0;
+    if (ply > 0 && probeScore(state, position, side, ply, tablebaseScore))
+        return tablebaseScore;
+    if (ply >= MAX_PLY - 1)
+        return evaluate(position, side, *state.shared->weights);
+
+    //A result from an earlier visit to this position may already settle it
+    const uint64_t key = positionKey(position, side);
+    TTEntry entry;
+    state.stats.ttProbes++;
+    const bool found = state.shared->table->probe(key, entry);
+    if (found)
+        state.stats.ttHits++;
+    if (found && entry.depth >= depth && ply > 0) {
+        const int score = scoreFromTable(entry.score, ply);
+        if (entry.bound == BoundExact
+                || (entry.bound == BoundLower && score >= beta)
+                || (entry.bound == BoundUpper && score <= alpha)) {
+            state.stats.ttCutoffs++;
+            return score;
+        }
     }
-    if (playerPiece == pieces[BlackKing]) { // Pieces that can move up
-        //bottom left square
-        it = gameBoard.find(std::make_pair(from.first - 1, from.second - 1));
-        if(it != gameBoard.end()){
-            if(it->second == pieces[Empty]){ //if the square is empty
-                possibleMoves.push_back(it->first);
+
+    //The stored move only counts if it is still the move at that index, a different position could share the slot
+    int ttIndex = -1;
+    if (found && entry.moveIndex >= 0 && entry.moveIndex < moveList.size
+            && moveList[entry.moveIndex].from == entry.from && moveList[entry.moveIndex].to == entry.to)
+        ttIndex = entry.moveIndex;
+    int order[MAX_MOVES];
+    orderMoves(state, moveList, ply, ttIndex, order);
+
+    const int enemy = (side == Black) ? White : Black;
+    const int originalAlpha = alpha;
+    int bestScore = -WIN_SCORE;
+    int bestIndex = order[0];
+    for (int n = 0; n < moveList.size; n++) {
+        //helper threads start on different root moves so they don't all search the same tree
+        const int i = order[(ply == 0) ? (n + state.threadIndex) % moveList.size : n];
+        makeMove(position, moveList[i], state.undo);
+        int score = -alphaBeta(state, position, enemy, depth - 1, ply + 1, -beta, -alpha);
+        unmakeMove(position, state.undo);
+        if (state.stopped)
+            return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestIndex = i;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(state, ply, moveList[i]);
             }
-        }
-        //bottom right square
-        it = gameBoard.find(std::make_pair(from.first + 1, from.second - 1));
-        if(it != gameBoard.end()){
-            if(it->second == pieces[Empty]){ //if the square is empty
-                possibleMoves.push_back(it->first);
+            if (alpha >= beta) {
+                state.stats.betaCutoffs++;
+                state.stats.cutoffs[std::min(n, CUTOFF_SLOTS - 1)]++;
+                updateOrdering(state, moveList[i], ply, depth);
+                break;
             }
         }
     }
-    if(possibleMoves.size() == 0){
-        return {'z', 'z'};
-    }else{
-        int randomIndex = rand() % possibleMoves.size();
-        return possibleMoves.at(randomIndex);
-    }
+
+    const int bound = (bestScore >= beta) ? BoundLower : ((bestScore > originalAlpha) ? BoundExact : BoundUpper);
+    state.shared->table->store(key, depth, bound, scoreToTable(bestScore, ply), moveList[bestIndex], bestIndex);
+    return bestScore;
 }
 
-std::pair<std::pair<char, char>, std::pair<char, char>> getMoveAI(std::map<std::pair<char, char>, char> & gameBoard,
-               int & playerTurn)
-{
-    //find all the pieces available to move
-    std::vector<std::pair<char, char>> pieceVec;
-    for (auto it = gameBoard.begin(); it != gameBoard.end(); ++it){
-        if (it->second == pieces[playerTurn] || it->second==pieces[playerTurn+1]){
-            pieceVec.push_back(it->first);
+//Iterative deepening loop run by every search thread. Only the main thread fills in the result and decides when to stop.
+static void iterativeDeepening(SearchState & state, const Position & position, const int & side, SearchResult & result){
+    const SearchLimits & limits = state.shared->limits;
+    const int maxDepth = (limits.maxDepth > 0) ? std::min(limits.maxDepth, MAX_PLY - 1) : MAX_PLY - 1;
+    const bool mainThread = (state.threadIndex == 0);
+    uint64_t previousNodes = 0;
+    int previousTimeMs = 0;
+
+    //half of the helpers run one ply ahead, so the threads fill the table with different depths
+    for (int depth = mainThread ? 1 : 1 + (state.threadIndex & 1); depth <= maxDepth; depth++) {
+        state.board = position;
+        state.undo.clear();
+        int score = alphaBeta(state, state.board, side, depth, 0, -WIN_SCORE, WIN_SCORE);
+        if (state.stopped)
+            break; //an unfinished iteration can't be trusted
+        if (searchTrace().enabled()) {
+            TraceRecord record;
+            record.type = TraceIteration;
+            record.thread = state.threadIndex;
+            record.position = position;
+            record.side = side;
+            record.depth = depth;
+            record.score = score;
+            record.nodes = state.stats.nodes + state.stats.qnodes;
+            record.timeMs = elapsedMs(*state.shared);
+            record.bestMove = state.pvTable[0][0];
+            searchTrace().push(record);
         }
+        if (!mainThread)
+            continue;
+
+        //the main thread's own nodes, the shared count is only topped up every 1024
+        const int timeMs = elapsedMs(*state.shared);
+        const uint64_t nodes = state.stats.nodes + state.stats.qnodes;
+        if (state.stats.iterationCount < MAX_ITERATIONS) {
+            IterationStats & iteration = state.stats.iterations[state.stats.iterationCount++];
+            iteration.depth = depth;
+            iteration.nodes = nodes - previousNodes;
+            iteration.timeMs = timeMs - previousTimeMs;
+        }
+        previousNodes = nodes;
+        previousTimeMs = timeMs;
+
+        result.score = score;
+        result.depth = depth;
+        result.pvLength = state.pvLength[0];
+        for (int i = 0; i < result.pvLength; i++)
+            result.pv[i] = state.pvTable[0][i];
+        if (result.pvLength > 0)
+            result.bestMove = result.pv[0];
+        if (limits.onIteration) {
+            result.stats = state.stats;
+            result.stats.timeMs = timeMs;
+            result.nodes = state.shared->nodes.load(std::memory_order_relaxed);
+            result.timeMs = elapsedMs(*state.shared);
+            limits.onIteration(result);
+        }
+
+        if (std::abs(score) >= WIN_SCORE - MAX_PLY)
+            break; //found a forced win or loss, searching deeper won't change it
+        if (limits.timeMs > 0 && !pondering(*state.shared, state.shared->nodes.load(std::memory_order_relaxed))
+                && (elapsedMs(*state.shared) - state.shared->limitsStartMs) * 2 >= limits.timeMs)
+            break; //the next iteration would not finish in time
     }
-    if (pieceVec.size() == 0){ // sanity check
-        std::cout<<"Programmer error: AI has no pieces to move."<<std::endl;
-        throw "Programmer error: AI has no pieces to move.";
+    if (mainThread)
+        state.shared->stop.store(true, std::memory_order_relaxed);
+}
+
+SearchResult searchPosition(const Position & position, const int & side, const SearchLimits & limits,
+                            TranspositionTable * table){
+    SearchShared shared;
+    shared.limits = limits;
+    shared.table = (table != nullptr) ? table : &transpositionTable;
+    shared.weights = (limits.weights != nullptr) ? limits.weights : &evalWeights();
+    shared.table->newSearch();
+    shared.start = std::chrono::steady_clock::now();
+    shared.pondering = (limits.ponder != nullptr && limits.ponder->load());
+
+    SearchResult result;
+    MoveList rootMoves;
+    generateMoves(position, side, rootMoves);
+    if (rootMoves.size == 0)
+        return result;
+    result.bestMove = rootMoves[0];
+    result.pv[0] = rootMoves[0];
+    result.pvLength = 1;
+    if (rootMoves.size == 1) //forced move, nothing to think about
+        return result;
+
+    //Lazy SMP: every thread runs its own iterative deepening and they share work through the transposition table
+    const int threadCount = std::max(1, limits.threads);
+    std::vector<std::unique_ptr<SearchState>> states;
+    for (int i = 0; i < threadCount; i++) {
+        states.emplace_back(new SearchState);
+        states.back()->shared = &shared;
+        states.back()->threadIndex = i;
     }
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threadCount; i++) {
+        SearchState * state = states.at(i).get();
+        helpers.emplace_back([state, &position, &side](){
+            SearchResult unused;
+            iterativeDeepening(*state, position, side, unused);
+        });
+    }
+    iterativeDeepening(*states.at(0), position, side, result);
+    for (auto & helper : helpers)
+        helper.join();
 
-    //Generates a vector Best Move, that contains the movement to make
-    std::pair<std::pair<char, char>, std::pair<char, char>> bestMove = std::make_pair(std::make_pair('z', 'z'), std::make_pair('z', 'z'));
-    int val = 0;
-    std::vector<std::pair<std::pair<char, char>, std::pair<char, char>>> possibleMoves {};
-    for(auto it = pieceVec.begin(); it != pieceVec.end(); ++it){//Search in all the available pieces to move
-        auto temp = findBestJumpMoveAI(gameBoard, *it);//Calls findBestJumpMoveAI
-        if(temp.first > val){ //Sees if the movement is better than the past one
-            std::vector<std::pair<std::pair<char, char>, std::pair<char, char>>> newPossibleMoves;
-            newPossibleMoves.push_back(std::make_pair(*it, temp.second));
-            val = temp.first;
-            possibleMoves = newPossibleMoves;
-        }else if (temp.first == val){
-            possibleMoves.push_back(std::make_pair(*it, temp.second));
-        }
+    result.stats = states.at(0)->stats;
+    for (int i = 1; i < threadCount; i++)
+        result.stats.add(states.at(i)->stats);
+    result.nodes = result.stats.nodes + result.stats.qnodes;
+    result.timeMs = elapsedMs(shared);
+    result.stats.timeMs = result.timeMs;
+    if (searchTrace().enabled()) {
+        TraceRecord record;
+        record.type = TraceResult;
+        record.position = position;
+        record.side = side;
+        record.depth = result.depth;
+        record.score = result.score;
+        record.nodes = result.nodes;
+        record.timeMs = result.timeMs;
+        record.bestMove = result.bestMove;
+        searchTrace().push(record);
     }
+    return result;
+}
 
-    if(val>0){//Assign a possible move from the best possibleMoves vector list
-        int randomIndex = rand() % possibleMoves.size();
-        bestMove = possibleMoves.at(randomIndex);
+std::string pvString(const SearchResult & result){
+    std::string line;
+    for (int i = 0; i < result.pvLength; i++) {
+        if (i > 0)
+            line += ' ';
+        line += moveName(result.pv[i]);
     }
+    return line;
+}
 
-    else { //Don't bother looking for a single square if a jump square was found
-        std::vector<std::pair<std::pair<char, char>, std::pair<char, char>>> possibleSingleMoves {};
-        for(auto it = pieceVec.begin(); it != pieceVec.end(); ++it){
-            std::pair<char, char> temp = findSingleSquareMoveAI(gameBoard, *it);
-            if (temp != std::make_pair('z', 'z')){
-                possibleSingleMoves.push_back(std::make_pair(*it, temp));
-            }
-        }
+static std::mutex lastSearchMutex;
+static SearchStats lastStats;
+static Move lastReply;
+static bool lastReplyKnown = false;
 
-        int randomIndex = rand() % possibleSingleMoves.size();
-        bestMove = possibleSingleMoves.at(randomIndex);
+SearchStats lastSearchStats(){
+    std::lock_guard<std::mutex> lock(lastSearchMutex);
+    return lastStats;
+}
+bool lastPredictedReply(Move & reply){
+    std::lock_guard<std::mutex> lock(lastSearchMutex);
+    if (lastReplyKnown)
+        reply = lastReply;
+    return lastReplyKnown;
+}
 
+std::pair<int, int> getMoveAI(const Position & position,
+                              const int & playerTurn)
+{
+    return getMoveAI(position, playerTurn, getSearchLimits());
+}
+std::pair<int, int> getMoveAI(const Position & position,
+                              const int & playerTurn,
+                              const SearchLimits & limits)
+{
+    Move move = chooseMoveAI(position, playerTurn, limits);
+    return std::make_pair(int(move.from), int(move.to));
+}
+Move chooseMoveAI(const Position & position,
+                  const int & playerTurn,
+                  const SearchLimits & limits)
+{
+    if (findPiecesRemaining(playerTurn, position) == 0){ // sanity check
+        std::cout<<"Programmer error: AI has no pieces to move."<<std::endl;
+        throw "Programmer error: AI has no pieces to move.";
     }
-    if (bestMove.second == std::make_pair('z', 'z')){ // Ensure a move has been found
+    if (checkStalemate(playerTurn, position)){ // Ensure a move can be found
         std::cout<<"Programmer error: AI has no valid moves."<<std::endl;
         throw "Programmer error: AI has no valid moves.";
     }
 
-    return bestMove;
+    Move bookMove;
+    if (limits.useBook && pickBookMove(position, playerTurn, bookMove)) {
+        {
+            std::lock_guard<std::mutex> lock(lastSearchMutex);
+            lastStats = SearchStats();
+            lastReplyKnown = false;
+        }
+        return bookMove;
+    }
+
+    SearchResult result = searchPosition(position, playerTurn, limits);
+    {
+        std::lock_guard<std::mutex> lock(lastSearchMutex);
+        lastStats = result.stats;
+        lastReplyKnown = (result.pvLength >= 2);
+        if (lastReplyKnown)
+            lastReply = result.pv[1];
+    }
+    return result.bestMove;
+}
+std::pair<std::pair<char, char>, std::pair<char, char>> getMoveAI(std::map<std::pair<char, char>, char> & gameBoard,
+               int & playerTurn)
+{
+    auto move = getMoveAI(toPosition(gameBoard), playerTurn);
+    return std::make_pair(squareName(move.first), squareName(move.second));
 }
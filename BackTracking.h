@@ -6,15 +6,95 @@
 
 #include <vector>
 #include <map>
-#include <stack>
+#include <string>
+#include <atomic>
+#include <functional>
+
+#include "Game.h"
+#include "TranspositionTable.h"
+#include "SearchStats.h"
+#include "Evaluate.h"
+
+static const int MAX_PLY = 128;
+static const int WIN_SCORE = 30000; //score for a side that has no moves left, less the plies it takes to get there
+//A tablebase win, plus the evaluation so the search heads for simpler wins. Even with the worst evaluation and
+//the deepest ply it stays above every clamped evaluation, and below the scores of wins on the board.
+static const int TB_WIN_SCORE = 2 * EVAL_LIMIT + MAX_PLY;
+static_assert(TB_WIN_SCORE - EVAL_LIMIT - (MAX_PLY - 1) > EVAL_LIMIT, "a tablebase win must outscore any evaluation");
+static_assert(TB_WIN_SCORE + EVAL_LIMIT < WIN_SCORE - MAX_PLY, "a tablebase win must not look like a win on the board");
+
+struct SearchResult;
+
+//How long the AI may search for each move. A limit of 0 is ignored.
+struct SearchLimits {
+    int maxDepth = 64;
+    int timeMs = 1000;
+    uint64_t maxNodes = 0; //alpha-beta and quiescence nodes together
+    int quiescencePlies = 32; //longest capture sequence played out past the horizon, 0 evaluates at the horizon
+    int threads = 1; //threads searching together on the shared transposition table
+    bool useBook = true; //getMoveAI plays from the opening book, when one is loaded, before searching
+    const EvalWeights * weights = nullptr; //evaluation weights, the ones set by setEvalWeights when null
+
+    std::atomic<bool> * stop = nullptr; //another thread sets this to cancel the search
+    std::atomic<bool> * ponder = nullptr; //while this is set the time and node limits are held off, once cleared they count from then
+    std::function<void(const SearchResult &)> onIteration; //progress report after each completed depth, called on the search thread
+};
+
+struct SearchResult {
+    Move bestMove;
+    int score = 0; //from the point of view of the side to move
+    int depth = 0; //deepest iteration that was completed
+    uint64_t nodes = 0;
+    int timeMs = 0;
+    int pvLength = 0;
+    Move pv[MAX_PLY]; //principal variation, starting with bestMove
+    SearchStats stats;
+};
 
 std::pair<int, std::pair<char, char>> findBestJumpMoveAI(const std::map<std::pair<char, char>, char> & gameBoard,
                                                          const std::pair<char, char> & from);
 
-std::pair<char, char> findSingleSquareMoveAI(const std::pair<char, char> & from,
-                      const std::map<std::pair<char, char>, char> & gameBoard);
+std::pair<char, char> findSingleSquareMoveAI(const std::map<std::pair<char, char>, char> & gameBoard,
+                                             const std::pair<char, char> & from);
 
 std::pair<std::pair<char, char>, std::pair<char, char>> getMoveAI(std::map<std::pair<char, char>, char> & gameBoard,
                int & playerTurn);
 
+//Bitboard versions. Squares are indices into the Position masks, -1 when no square was found.
+std::pair<int, int> findBestJumpMoveAI(const Position & position,
+                                       const int & from);
+
+int findSingleSquareMoveAI(const Position & position,
+                           const int & from);
+
+std::pair<int, int> getMoveAI(const Position & position,
+                              const int & playerTurn);
+std::pair<int, int> getMoveAI(const Position & position,
+                              const int & playerTurn,
+                              const SearchLimits & limits);
+//The whole move getMoveAI picks, capture route included. Two captures can join the same squares by different
+//routes, so playing it from its end squares alone could take other tokens than the ones the search scored.
+Move chooseMoveAI(const Position & position,
+                  const int & playerTurn,
+                  const SearchLimits & limits);
+
+//The limits getMoveAI searches with
+void setSearchLimits(const SearchLimits & limits);
+SearchLimits getSearchLimits();
+
+//Statistics of the last search getMoveAI ran
+SearchStats lastSearchStats();
+//The reply the last getMoveAI search expects, the second move of its principal variation. Pondering searches the
+//position after it on the opponent's time. False after a book move or when the line was too short.
+bool lastPredictedReply(Move & reply);
+
+//Table getMoveAI searches with, and the default for searchPosition
+TranspositionTable & sharedTranspositionTable();
+
+//Iterative deepening alpha-beta search. The side to move must have at least one legal move.
+SearchResult searchPosition(const Position & position, const int & side, const SearchLimits & limits,
+                            TranspositionTable * table = nullptr);
+
+std::string pvString(const SearchResult & result);
+
 #endif
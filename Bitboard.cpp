@@ -0,0 +1,17 @@
+#include "Bitboard.h"
+
+//Returns -1 for squares that are off the board or not playable
+int squareIndex(const std::pair<char, char> & square){
+    int column = square.first - 'a';
+    int row = square.second - '1';
+    if (column < 0 || column > 7 || row < 0 || row > 7)
+        return -1;
+    if ((row % 2) != (column % 2)) //light square
+        return -1;
+    return row * 4 + column / 2;
+}
+std::pair<char, char> squareName(const int & square){
+    int row = square / 4;
+    int column = 2 * (square % 4) + (row % 2);
+    return std::make_pair(char('a' + column), char('1' + row));
+}
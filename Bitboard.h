@@ -0,0 +1,168 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//32-square board representation. Only the dark squares are playable, so each colour fits in a 32-bit mask.
+//Bit n is the n-th playable square counting from a1 along each rank, four squares per rank:
+//  rank 8:  b8=28 d8=29 f8=30 h8=31
+//  ...
+//  rank 2:  b2=4  d2=5  f2=6  h2=7
+//  rank 1:  a1=0  c1=1  e1=2  g1=3
+//Black starts on ranks 1-3 and moves up the board, White starts on ranks 6-8 and moves down.
+struct Position {
+    uint32_t black = 0; //all black tokens, kings included
+    uint32_t white = 0; //all white tokens, kings included
+    uint32_t kings = 0; //kings of either colour
+    uint64_t hash = 0; //Zobrist key of the pieces, kept up to date by movePiece, removeSquare and checkCrown
+};
+
+typedef enum Direction{
+    UpRight = 0, //towards h8
+    UpLeft,      //towards a8
+    DownRight,   //towards h1
+    DownLeft     //towards a1
+}Direction;
+
+namespace BB{
+    static const uint32_t ALL_SQUARES = 0xFFFFFFFF;
+    static const uint32_t RANK_1 = 0x0000000F; //White crowns here
+    static const uint32_t RANK_8 = 0xF0000000; //Black crowns here
+
+    static const uint32_t RANKS_1357 = 0x0F0F0F0F; //squares start on the a file
+    static const uint32_t RANKS_2468 = 0xF0F0F0F0; //squares start on the b file
+
+    //A diagonal step is a shift by 4 everywhere, plus a shift by 3 or 5 depending on the rank parity.
+    //These are the squares that can take the 3/5 shift without wrapping around the board edge.
+    //Moving off the top or bottom of the board is dropped by the 32-bit truncation.
+    static const uint32_t RANKS_1357_NO_A = 0x0E0E0E0E;
+    static const uint32_t RANKS_2468_NO_H = 0x70707070;
+
+    static const int NO_SQUARE = -1; //table entry for a step that leaves the board
+
+    //Square 'distance' diagonal steps away in the given direction, NO_SQUARE if that leaves the board
+    constexpr int stepSquare(const int square, const int direction, const int distance){
+        const int row = square / 4 + ((direction == UpRight || direction == UpLeft) ? distance : -distance);
+        const int column = 2 * (square % 4) + (square / 4) % 2 + ((direction == UpRight || direction == DownRight) ? distance : -distance);
+        return (row < 0 || row > 7 || column < 0 || column > 7) ? NO_SQUARE : row * 4 + column / 2;
+    }
+    //For every square, the square reached in each Direction, indexed as table[square][direction]
+    struct StepTable {
+        int8_t to[32][4];
+
+        constexpr const int8_t * operator[](const int square) const{
+            return to[square];
+        }
+    };
+    constexpr StepTable makeStepTable(const int distance){
+        StepTable table{};
+        for(int square = 0; square < 32; square++){
+            for(int direction = UpRight; direction <= DownLeft; direction++)
+                table.to[square][direction] = int8_t(stepSquare(square, direction, distance));
+        }
+        return table;
+    }
+    //Built at compile time, so the rules look steps up rather than working them out from coordinates
+    static constexpr StepTable NEIGHBOUR = makeStepTable(1);
+    static constexpr StepTable JUMP = makeStepTable(2); //landing square of a jump, over NEIGHBOUR in the same direction
+
+    static_assert(NEIGHBOUR[0][UpRight] == 4 && NEIGHBOUR[0][UpLeft] == NO_SQUARE, "a1 steps to b2 only");
+    static_assert(NEIGHBOUR[31][DownLeft] == 27 && NEIGHBOUR[31][DownRight] == NO_SQUARE, "h8 steps to g7 only");
+    static_assert(JUMP[0][UpRight] == 9 && JUMP[5][DownLeft] == NO_SQUARE, "a1 jumps to c3, d2 can't jump down");
+}
+
+//Shift a whole mask one diagonal step. Pieces that would leave the board are dropped.
+inline uint32_t shiftUpRight(const uint32_t & mask){
+    return ((mask & BB::RANKS_1357) << 4) | ((mask & BB::RANKS_2468_NO_H) << 5);
+}
+inline uint32_t shiftUpLeft(const uint32_t & mask){
+    return ((mask & BB::RANKS_1357_NO_A) << 3) | ((mask & BB::RANKS_2468) << 4);
+}
+inline uint32_t shiftDownRight(const uint32_t & mask){
+    return ((mask & BB::RANKS_1357) >> 4) | ((mask & BB::RANKS_2468_NO_H) >> 3);
+}
+inline uint32_t shiftDownLeft(const uint32_t & mask){
+    return ((mask & BB::RANKS_1357_NO_A) >> 5) | ((mask & BB::RANKS_2468) >> 4);
+}
+inline uint32_t shiftMask(const uint32_t & mask, const int & direction){
+    switch(direction){
+    case UpRight:
+        return shiftUpRight(mask);
+    case UpLeft:
+        return shiftUpLeft(mask);
+    case DownRight:
+        return shiftDownRight(mask);
+    default:
+        return shiftDownLeft(mask);
+    }
+}
+
+inline int bitCount(const uint32_t & mask){
+#ifdef _MSC_VER
+    return int(__popcnt(mask));
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+//Index of the lowest set square. The mask must not be empty.
+inline int lowestSquare(const uint32_t & mask){
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+inline uint32_t squareMask(const int & square){
+    return uint32_t(1) << square;
+}
+//Turning the board round maps square n to 31 - n, which reverses the bits
+inline uint32_t flipMask(uint32_t mask){
+    mask = ((mask >> 1) & 0x55555555) | ((mask & 0x55555555) << 1);
+    mask = ((mask >> 2) & 0x33333333) | ((mask & 0x33333333) << 2);
+    mask = ((mask >> 4) & 0x0F0F0F0F) | ((mask & 0x0F0F0F0F) << 4);
+    mask = ((mask >> 8) & 0x00FF00FF) | ((mask & 0x00FF00FF) << 8);
+    return (mask >> 16) | (mask << 16);
+}
+
+//Square one diagonal step away, or -1 (BB::NO_SQUARE) if that would leave the board
+inline int neighbour(const int & square, const int & direction){
+    return BB::NEIGHBOUR[square][direction];
+}
+//Landing square of a jump in the given direction, or -1 if it would leave the board
+inline int jumpLanding(const int & square, const int & direction){
+    return BB::JUMP[square][direction];
+}
+//Square that is jumped over when going from -> to, or -1 if the two squares are not a jump apart
+inline int jumpedSquare(const int & from, const int & to){
+    for(int direction = UpRight; direction <= DownLeft; direction++){
+        if(BB::JUMP[from][direction] == to)
+            return BB::NEIGHBOUR[from][direction];
+    }
+    return BB::NO_SQUARE;
+}
+
+//Standard PDN square numbers (1-32). Square 1 is in the corner of Black's home rank (g1) and the
+//numbers run across each rank away from Black, so Black starts on 1-12 and White on 21-32.
+inline int pdnSquare(const int & square){
+    return 4 * (square / 4) + (3 - square % 4) + 1;
+}
+//Returns -1 for numbers that are not on the board
+inline int fromPdnSquare(const int & number){
+    if (number < 1 || number > 32)
+        return -1;
+    return 4 * ((number - 1) / 4) + (3 - (number - 1) % 4);
+}
+
+//Conversions between the board coordinates used by the GUI ('a'-'h', '1'-'8') and square indices
+int squareIndex(const std::pair<char, char> & square);
+std::pair<char, char> squareName(const int & square);
+
+#endif // BITBOARD_H
@@ -11,6 +11,8 @@
 #include <QGraphicsScene>
 #include <QDrag>
 
+#include "main.h"
+
 
 class GamePiece : public QGraphicsItem
 {
@@ -45,6 +47,24 @@ public:
         this->x = p.x();
         this->y = p.y();
     }
+    //Moves the piece to another square without recreating it
+    void moveToSquare(int x, int y, std::pair<char, char> square){
+        prepareGeometryChange(); //the bounding rect is in scene coordinates
+        this->x = x;
+        this->y = y;
+        this->square = square;
+        update();
+    }
+    void setKing(bool king){
+        this->king = king;
+        update();
+    }
+    bool isKing() const{
+        return king;
+    }
+    QColor getColor() const{
+        return color;
+    }
 private:
     void mousePressEvent(QGraphicsSceneMouseEvent * event){
         setCursor(Qt::ClosedHandCursor);
@@ -57,6 +77,8 @@ private:
                    event->buttonDownScreenPos(Qt::LeftButton)).length() < QApplication::startDragDistance()) {
             return;
         }
+        if (aiThinking()) //the AI's move could take this piece while the drag runs
+            return;
         QRect rect = boundingRect().toRect();
 
         QPixmap pixmap(rect.size());
@@ -89,8 +111,12 @@ private:
 
         hide();
         update();
+        dragStarted();
         drag->exec();
-        //Returns here once the drag has finished executing
+        //Returns here once the drag has finished executing. The piece may have been taken off the scene meanwhile,
+        //but it is only freed after dragFinished.
+        show(); //the piece is kept, and moved, rather than redrawn, so bring it back if it was dropped somewhere useless
+        dragFinished();
     }
     void mouseReleaseEvent(QGraphicsSceneMouseEvent * event)
     {
@@ -0,0 +1,30 @@
+#Builds everything: qmake Checkers.pro && make
+#The engine library first, then the GUI and the headless tools that link it.
+
+TEMPLATE = subdirs
+
+SUBDIRS = core gui perft bench tablebase book tournament tune
+
+core.file = core/checkers_core.pro
+
+gui.file = CheckersGameGUI.pro
+gui.makefile = Makefile.gui #shares this directory, so it needs its own makefile
+gui.depends = core
+
+perft.file = perft/checkers_perft.pro
+perft.depends = core
+
+bench.file = bench/checkers_bench.pro
+bench.depends = core
+
+tablebase.file = tablebase/checkers_tablebase.pro
+tablebase.depends = core
+
+book.file = book/checkers_book.pro
+book.depends = core
+
+tournament.file = tournament/checkers_tournament.pro
+tournament.depends = core
+
+tune.file = tune/checkers_tune.pro
+tune.depends = core
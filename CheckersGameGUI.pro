@@ -1,21 +1,22 @@
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = CheckersGameGUI
 TEMPLATE = app
+CONFIG += c++17
 
 DEFINES += QT_DEPRECATED_WARNINGS
 
+#The rules and AI come from libcheckers_core, built by Checkers.pro into core/
+CORE_BUILD_DIR = $$OUT_PWD/core
+include(core/checkers_core.pri)
+
 SOURCES += \
-    BackTracking.cpp \
-    Game.cpp \
         main.cpp
 
 HEADERS += \
-    BackTracking.h \
     Check.h \
-    Game.h \
     MovePiece.h \
     Square.h \
     main.h
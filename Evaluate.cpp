@@ -0,0 +1,106 @@
+#include "Evaluate.h"
+
+#include <algorithm>
+#include <fstream>
+
+static const uint32_t CENTRE = 0x00666600; //c3, e3, d4, f4, c5, e5, d6, f6
+static const uint32_t RUNAWAY_RANKS = 0x0FFF0000; //ranks 5-7
+
+static const char * termNames[EVAL_TERMS] = {
+    "Man", "King", "BackRank", "Centre", "KingCentre", "Mobility", "Runaway", "Tempo"
+};
+
+static EvalWeights loadedWeights;
+
+//Counts for one side, seen from its own end of the board so that its men move up
+static void sideFeatures(const uint32_t & men, const uint32_t & kings, const uint32_t & enemy, int features[EVAL_TERMS]){
+    const uint32_t pieces = men | kings;
+    const uint32_t empty = ~(pieces | enemy);
+
+    features[EvalMan] = bitCount(men);
+    features[EvalKing] = bitCount(kings);
+    features[EvalBackRank] = bitCount(men & BB::RANK_1);
+    features[EvalCentre] = bitCount(men & CENTRE);
+    features[EvalKingCentre] = bitCount(kings & CENTRE);
+    features[EvalMobility] = bitCount(shiftUpRight(pieces) & empty) + bitCount(shiftUpLeft(pieces) & empty)
+            + bitCount(shiftDownRight(kings) & empty) + bitCount(shiftDownLeft(kings) & empty);
+
+    //Spread back from the crowning rank over empty squares that no enemy piece is next to
+    const uint32_t touched = shiftUpRight(enemy) | shiftUpLeft(enemy) | shiftDownRight(enemy) | shiftDownLeft(enemy);
+    const uint32_t open = empty & ~touched;
+    uint32_t path = BB::RANK_8 & open;
+    for (int rank = 0; rank < 2; rank++) //down to rank 6, the last one a man on rank 5 needs
+        path |= (shiftDownRight(path) | shiftDownLeft(path)) & open;
+    features[EvalRunaway] = bitCount(men & RUNAWAY_RANKS & (shiftDownRight(path) | shiftDownLeft(path)));
+
+    //A man on rank n counts n - 1: once for every rank mask above rank 1 it is in
+    int tempo = 0;
+    for (int rank = 1; rank < 8; rank++)
+        tempo += bitCount(men & (BB::ALL_SQUARES << (4 * rank)));
+    features[EvalTempo] = tempo;
+}
+
+void evalFeatures(const Position & position, const int & side, int features[EVAL_TERMS]){
+    int black[EVAL_TERMS];
+    int white[EVAL_TERMS];
+    sideFeatures(position.black & ~position.kings, position.black & position.kings, position.white, black);
+    //White is counted on the board turned round, so the same code serves both sides
+    sideFeatures(flipMask(position.white & ~position.kings), flipMask(position.white & position.kings), flipMask(position.black), white);
+    for (int term = 0; term < EVAL_TERMS; term++)
+        features[term] = (side == Black) ? black[term] - white[term] : white[term] - black[term];
+}
+
+int evaluate(const Position & position, const int & side, const EvalWeights & weights){
+    int features[EVAL_TERMS];
+    evalFeatures(position, side, features);
+    int score = 0;
+    for (int term = 0; term < EVAL_TERMS; term++)
+        score += weights.weight[term] * features[term];
+    return std::max(-EVAL_LIMIT, std::min(EVAL_LIMIT, score));
+}
+int evaluate(const Position & position, const int & side){
+    return evaluate(position, side, loadedWeights);
+}
+
+const EvalWeights & evalWeights(){
+    return loadedWeights;
+}
+void setEvalWeights(const EvalWeights & weights){
+    loadedWeights = weights;
+}
+
+const char * evalTermName(const int & term){
+    return (term >= 0 && term < EVAL_TERMS) ? termNames[term] : "";
+}
+bool readEvalWeights(const std::string & path, EvalWeights & weights){
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    EvalWeights read = weights;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string name;
+        int value = 0;
+        if (!(fields >> name))
+            continue; //blank or only a comment
+        if (!(fields >> value))
+            return false;
+        int term = 0;
+        while (term < EVAL_TERMS && name != termNames[term])
+            term++;
+        if (term == EVAL_TERMS)
+            return false;
+        read.weight[term] = value;
+    }
+    weights = read;
+    return true;
+}
+bool writeEvalWeights(const std::string & path, const EvalWeights & weights){
+    std::ofstream file(path, std::ios::trunc);
+    file << "#Evaluation weights: name, then score points per unit of the term" << std::endl;
+    for (int term = 0; term < EVAL_TERMS; term++)
+        file << termNames[term] << " " << weights.weight[term] << std::endl;
+    return bool(file);
+}
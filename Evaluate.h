@@ -0,0 +1,43 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include <string>
+
+#include "Game.h"
+
+static const int EVAL_LIMIT = 5000; //evaluations are clamped to this, TB_WIN_SCORE in BackTracking.h is set to stay clear of it
+
+//Terms of the evaluation. Each is a count for the side to move less the same count for the other side.
+typedef enum Eval_Term{
+    EvalMan = 0,    //men
+    EvalKing,       //kings
+    EvalBackRank,   //men still guarding the home rank, which keeps enemy men from crowning
+    EvalCentre,     //men on the centre squares, c3-f6
+    EvalKingCentre, //kings on the centre squares
+    EvalMobility,   //single square moves
+    EvalRunaway,    //men on ranks 5-7 with a path to the crowning rank no enemy piece touches
+    EvalTempo,      //ranks the men have advanced, added up
+    EVAL_TERMS
+}Eval_Term;
+
+struct EvalWeights {
+    int weight[EVAL_TERMS] = { 100, 150, 10, 5, 8, 2, 40, 1 };
+};
+
+//Term counts of the position, for the side to move. Masks, shifts and popcounts only.
+void evalFeatures(const Position & position, const int & side, int features[EVAL_TERMS]);
+
+//Score for the side to move
+int evaluate(const Position & position, const int & side, const EvalWeights & weights);
+int evaluate(const Position & position, const int & side); //with the weights set by setEvalWeights
+
+//Weights evaluate uses by default. Must not be changed while a search is running.
+const EvalWeights & evalWeights();
+void setEvalWeights(const EvalWeights & weights);
+
+const char * evalTermName(const int & term);
+//Weights files hold one "name value" pair per line; # starts a comment. Terms that aren't given keep their value.
+bool readEvalWeights(const std::string & path, EvalWeights & weights);
+bool writeEvalWeights(const std::string & path, const EvalWeights & weights);
+
+#endif // EVALUATE_H
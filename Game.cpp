@@ -2,61 +2,116 @@
 #define GAME
 
 #include "Game.h"
+#include "Tablebase.h"
 
-void emptyBoard(std::map<std::pair<char, char>, char> & gameBoard){
-    std::map<std::pair<char, char>, char> temp;
-    for (char y = '1'; y <= '8'; y++) {
-        for (char x = 'a'; x <= 'h'; x++) {
-            if ((((y - 1) % 2) == 0) == (((x - 97) % 2) == 0)) { //XNOR to help with the diagonalness of the board
-                temp[std::make_pair(x, y)] = pieces[Empty];
-            }
-            //else -> not on board, so doesn't matter
-        }
-    }
-    gameBoard = temp;
+static std::vector<std::pair<char, char>> squareNames(const std::vector<int> & squares){
+    std::vector<std::pair<char, char>> names;
+    for (auto el : squares)
+        names.push_back(squareName(el));
+    return names;
 }
-void customBoardEightPiecesEach(std::map<std::pair<char, char>, char> & gameBoard) {
-    std::map<std::pair<char, char>, char> temp;
-    char currentPiece = '0';
-    for (char y = '1'; y <= '8'; y++) {
-        if (y <= '2')
-            currentPiece = pieces[Black];
-        else if (y >= '7')
-            currentPiece = pieces[White];
-        else
-            currentPiece = pieces[Empty];
 
-        for (char x = 'a'; x <= 'h'; x++) {
-            if ((((y - 1) % 2) == 0) == (((x - 97) % 2) == 0)) { //XNOR to help with the diagonalness of the board
-                temp[std::make_pair(x, y)] = currentPiece;
-            }
-            //else -> not on board, so doesn't matter
-        }
+//Random keys for Zobrist hashing: one per piece type per square, and one for White to move
+struct ZobristKeys {
+    uint64_t pieces[4][32]; //black token, black king, white token, white king
+    uint64_t whiteToMove;
+
+    ZobristKeys(){
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+        auto next = [&seed](){ //splitmix64, so the keys are the same on every run
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        for (auto & piece : pieces)
+            for (auto & key : piece)
+                key = next();
+        whiteToMove = next();
+    }
+};
+static const ZobristKeys zobrist;
+
+//Which of the zobrist.pieces tables the token on the square uses, -1 if the square is empty
+static int zobristPiece(const Position & position, const uint32_t & squareBit){
+    const int king = (position.kings & squareBit) ? 1 : 0;
+    if (position.black & squareBit)
+        return king;
+    if (position.white & squareBit)
+        return 2 + king;
+    return -1;
+}
+uint64_t computeHash(const Position & position){
+    uint64_t hash = 0;
+    for (uint32_t remaining = position.black | position.white; remaining; remaining &= remaining - 1) {
+        const int square = lowestSquare(remaining);
+        hash ^= zobrist.pieces[zobristPiece(position, squareMask(square))][square];
+    }
+    return hash;
+}
+uint64_t positionKey(const Position & position, const int & side){
+    return (side == White) ? (position.hash ^ zobrist.whiteToMove) : position.hash;
+}
 
+Position toPosition(const std::map<std::pair<char, char>, char> & gameBoard){
+    Position position;
+    for (auto el : gameBoard) {
+        int square = squareIndex(el.first);
+        if (square < 0) //not on board, so doesn't matter
+            continue;
+        if (el.second == pieces[Black] || el.second == pieces[BlackKing])
+            position.black |= squareMask(square);
+        else if (el.second == pieces[White] || el.second == pieces[WhiteKing])
+            position.white |= squareMask(square);
+        if (el.second == pieces[BlackKing] || el.second == pieces[WhiteKing])
+            position.kings |= squareMask(square);
     }
+    position.hash = computeHash(position);
+    return position;
+}
+void fromPosition(const Position & position, std::map<std::pair<char, char>, char> & gameBoard){
+    std::map<std::pair<char, char>, char> temp;
+    for (int square = 0; square < 32; square++)
+        temp[squareName(square)] = pieceAt(position, square);
     gameBoard = temp;
 }
+char pieceAt(const Position & position, const int & square){
+    const uint32_t bit = squareMask(square);
+    const bool king = (position.kings & bit) != 0;
+    if (position.black & bit)
+        return pieces[king ? BlackKing : Black];
+    if (position.white & bit)
+        return pieces[king ? WhiteKing : White];
+    return pieces[Empty];
+}
 
+void emptyBoard(Position & position){
+    position = Position();
+}
+void emptyBoard(std::map<std::pair<char, char>, char> & gameBoard){
+    fromPosition(Position(), gameBoard);
+}
+void customBoardEightPiecesEach(Position & position){
+    emptyBoard(position);
+    position.black = 0x000000FF; //ranks 1-2
+    position.white = 0xFF000000; //ranks 7-8
+    position.hash = computeHash(position);
+}
+void customBoardEightPiecesEach(std::map<std::pair<char, char>, char> & gameBoard) {
+    Position position;
+    customBoardEightPiecesEach(position);
+    fromPosition(position, gameBoard);
+}
+void boardReset(Position & position){
+    emptyBoard(position);
+    position.black = 0x00000FFF; //ranks 1-3
+    position.white = 0xFFF00000; //ranks 6-8
+    position.hash = computeHash(position);
+}
 void boardReset(std::map<std::pair<char, char>, char> & gameBoard) {
-    std::map<std::pair<char, char>, char> temp;
-    char currentPiece = '0';
-    for (char y = '1'; y <= '8'; y++) {
-        if (y <= '3')
-            currentPiece = pieces[Black];
-        else if (y >= '6')
-            currentPiece = pieces[White];
-        else
-            currentPiece = pieces[Empty];
-
-        for (char x = 'a'; x <= 'h'; x++) {
-            if ((((y - 1) % 2) == 0) == (((x - 97) % 2) == 0)) { //XNOR to help with the diagonalness of the board
-                temp[std::make_pair(x, y)] = currentPiece;
-            }
-            //else -> not on board, so doesn't matter
-        }
-
-    }
-    gameBoard = temp;
+    Position position;
+    boardReset(position);
+    fromPosition(position, gameBoard);
 }
 //Depreciated: Prints board into console output
 void showBoard(const std::map<std::pair<char, char>, char> & gameBoard) {
@@ -66,8 +121,7 @@ void showBoard(const std::map<std::pair<char, char>, char> & gameBoard) {
     for (char y = '8'; y >= '1'; y--) {
         buf << y << " |";
         for (char x = 'a'; x <= 'h'; x++) {
-            //std::cout << x << " " << y << std::endl;
-            if ((((y - 1) % 2) == 0) == (((x - 97) % 2) == 0)) //XNOR to help with the diagonalness of the board
+            if (squareIndex({ x, y }) >= 0) //only the dark squares are on the board
                 buf << " " << gameBoard.at({ x, y });
             else {
                 buf << "  ";
@@ -83,74 +137,77 @@ void showBoard(const std::map<std::pair<char, char>, char> & gameBoard) {
     buf << std::endl;
     std::cout << buf.str();
 }
+uint32_t findPiecesRemaining(const int & player, const Position & position){
+    return (player == Black) ? position.black : position.white;
+}
 std::vector<std::pair<char, char>> findPiecesRemaining(const int & player,
                                                        const std::map<std::pair<char, char>, char> & gameBoard) {
     std::vector<std::pair<char, char>> tokens;
-    for (auto el : gameBoard) {
-        if (el.second == pieces[player]) //regular pieces
-            tokens.push_back(el.first);
-        if (el.second == pieces[player + 1]) //kings
-            tokens.push_back(el.first);
-    }
+    for (uint32_t remaining = findPiecesRemaining(player, toPosition(gameBoard)); remaining; remaining &= remaining - 1)
+        tokens.push_back(squareName(lowestSquare(remaining)));
     return tokens;
 }
 //Checks if there are any valid moves for the player specified. If not, there is a stalemate
+bool checkStalemate(const int & playerTurn, const Position & position) {
+    const uint32_t empty = ~(position.black | position.white);
+    const uint32_t own = findPiecesRemaining(playerTurn, position);
+    const uint32_t enemy = (playerTurn == Black) ? position.white : position.black;
+    const uint32_t upMovers = (playerTurn == Black) ? own : (own & position.kings);
+    const uint32_t downMovers = (playerTurn == White) ? own : (own & position.kings);
+
+    uint32_t moves = (shiftUpRight(upMovers) | shiftUpLeft(upMovers)
+                      | shiftDownRight(downMovers) | shiftDownLeft(downMovers)) & empty;
+    uint32_t jumps = (shiftUpRight(shiftUpRight(upMovers) & enemy) | shiftUpLeft(shiftUpLeft(upMovers) & enemy)
+                      | shiftDownRight(shiftDownRight(downMovers) & enemy) | shiftDownLeft(shiftDownLeft(downMovers) & enemy)) & empty;
+    return (moves | jumps) == 0; //If a move was found, there is no stalemate
+}
 bool checkStalemate(const int & playerTurn, const std::map<std::pair<char, char>, char> & gameBoard) {
-    auto playerPieces = findPiecesRemaining(playerTurn, gameBoard);
-    bool moveFound = false;
-    for(auto el : playerPieces){
-        if( singleSquareMove(el, std::make_pair('z', 'z') /*invalid TO position, as it won't be used*/, gameBoard, true)){
-            moveFound = true;
-            break;
-        }else if (findJumpSquares(playerTurn, el, gameBoard).first.size() > 0){
-            moveFound = true;
-            break;
-        }
-    }
-    return !moveFound; //If a move was found, there is no stalemate
+    return checkStalemate(playerTurn, toPosition(gameBoard));
 }
 //Promotes tokens to kings if on the last rank of enemy lines
-void checkCrown(std::map<std::pair<char, char>, char> & gameBoard) {
-    for (auto el : gameBoard) {
-        if ((el.first).second == '8')
-            if (el.second == pieces[Black])
-                gameBoard[el.first] = pieces[BlackKing];
-        if ((el.first).second == '1')
-            if (el.second == pieces[White])
-                gameBoard[el.first] = pieces[WhiteKing];
+void checkCrown(Position & position) {
+    const uint32_t crowned = ((position.black & BB::RANK_8) | (position.white & BB::RANK_1)) & ~position.kings;
+    for (uint32_t remaining = crowned; remaining; remaining &= remaining - 1) {
+        const int square = lowestSquare(remaining);
+        const int piece = zobristPiece(position, squareMask(square));
+        position.hash ^= zobrist.pieces[piece][square] ^ zobrist.pieces[piece + 1 /*king*/][square];
     }
+    position.kings |= crowned;
+}
+void checkCrown(std::map<std::pair<char, char>, char> & gameBoard) {
+    Position position = toPosition(gameBoard);
+    checkCrown(position);
+    fromPosition(position, gameBoard);
 }
 
 //Makes move if legal, returns errors if it is not
-std::pair<bool, std::pair<std::vector<std::pair<char, char>>, std::vector<std::pair<char, char>>>> checkMove(const int & player,
-                                                                                                             const std::pair<char, char> & from,
-                                                                                                             const std::pair<char, char> & to,
-                                                                                                             const std::map<std::pair<char, char>, char> & gameBoard)
+std::pair<bool, std::pair<std::vector<int>, std::vector<int>>> checkMove(const int & player,
+                                                                         const int & from,
+                                                                         const int & to,
+                                                                         const Position & position)
 {
     bool errors = false;
-    std::pair<std::vector<std::pair<char, char>>, std::vector<std::pair<char, char>>> returnResult;
+    std::pair<std::vector<int>, std::vector<int>> returnResult;
 
-    auto fromIt = gameBoard.find(from);
-    if (gameBoard.find(from) == gameBoard.end()) { //Check if tiles selected are on the board or not
+    if (from < 0) { //Check if tiles selected are on the board or not
         std::cout << "Invalid FROM location." << std::endl;
         errors = true;
     }
     else {
         //Ensure player is trying to move their own piece
-        if ((fromIt->second != pieces[player]) && (fromIt->second != pieces[player + 1/*king*/])) {
+        if (!(findPiecesRemaining(player, position) & squareMask(from))) {
             std::cout << "Invalid FROM location." << std::endl;
             errors = true;
         }
     }
 
-    auto toIt = gameBoard.find(to);
-    if (gameBoard.find(to) == gameBoard.end()) { //Check if tiles selected are on the board or not
+    if (to < 0) { //Check if tiles selected are on the board or not
         std::cout << "Invalid TO location." << std::endl;
         errors = true;
     }
     else {
-        //Check if space player is trying to move to is free
-        if (toIt->second != pieces[Empty]) {
+        //Check if space player is trying to move to is free. A king can capture its way round back to where it started.
+        if (to != from && ((position.black | position.white) & squareMask(to))) {
             std::cout << "Invalid TO location" << std::endl;
             errors = true;
         }
@@ -158,12 +215,20 @@ std::pair<bool, std::pair<std::vector<std::pair<char, char>>, std::vector<std::p
 
     //Is there a valid jumping path
     if (!errors) {
-        if (singleSquareMove(from, to, gameBoard)) {
-            errors = false;
-            returnResult.first.push_back(to);
+        MoveList moveList;
+        generateMoves(position, player, moveList);
+        const bool captureAvailable = (moveList.size > 0 && moveList[0].jumps > 0); //only captures are listed then
+        if (singleSquareMove(from, to, position)) {
+            if (captureAvailable) {
+                std::cout << "A capture is available, it must be taken." << std::endl;
+                errors = true;
+            }
+            else {
+                returnResult.first.push_back(to);
+            }
         }
         else {
-            auto result = jumpPathSearch(from, to, gameBoard);
+            auto result = jumpPathSearch(from, to, position);
             if (!result.first) {
                 std::cout << "No legal path found." << std::endl;
                 errors = true;
@@ -176,258 +241,163 @@ std::pair<bool, std::pair<std::vector<std::pair<char, char>>, std::vector<std::p
     }
     return { /*Was the move error-free?*/ !errors, returnResult };
 }
-std::pair<bool, std::pair<std::vector<std::pair<char, char>>, std::vector<std::pair<char, char>>>> jumpPathSearch(const std::pair<char, char> & from,
-                                                                                                                  const std::pair<char, char> & to,
-                                                                                                                  const std::map<std::pair<char, char>, char> & gameBoard){
-
-    std::set<std::pair<char, char>> possibilities {}; //squares that need to be searched
-    std::set<std::pair<char, char>> searchedPossibilities{}; //squares that were already searched through
-
-    std::vector<std::pair<char, char>> path{}; //squares jumped to while on way to the "TO" square
-    std::vector<std::pair<char, char>> jumpedActual{}; //enemy tokens that were jumped over in the process
-    bool pathFound = false;
-    int playerPiece = gameBoard.at(from);
-
-    struct Node {
-    public:
-        std::pair<char, char> square; //Which square this is
-        std::stack<std::pair<char, char>> jumpPoints; //Where this node can jump to
-        std::pair<char, char> jumpedOver = { 0,0 }; //What enemy token this node has jumped over
-        bool searched = false;
-        std::shared_ptr<Node> fromPtr = nullptr;
-        Node(std::pair<char, char> square, std::shared_ptr<Node> fromPtr, std::pair<char, char> jumpedOver) {
-            this->square = square;
-            this->fromPtr = fromPtr;
-            this->jumpedOver = jumpedOver;
-        }
-        Node(std::pair<char, char> x) {
-            square = x;
-        }
-        Node() {
-
-        }
-    };
-    //typedef std::shared_ptr<Node> NodePtr;
-
-    Node current (from);
-    possibilities.insert(from);
-
-    //auto temp = findJumpSquares(player, current.square, gameBoard);
-    while (possibilities != searchedPossibilities) {
-        auto temp = findJumpSquares(playerPiece, current.square, gameBoard);
-        if (pathFound) {
-            path.push_back(current.square);
-            if (current.fromPtr == nullptr) {
-                break;
-            }
-            else {
-                jumpedActual.push_back(current.jumpedOver);
-                current = *(current.fromPtr);
-            }
-
+std::pair<bool, std::pair<std::vector<std::pair<char, char>>, std::vector<std::pair<char, char>>>> checkMove(const int & player,
+                                                                                                             const std::pair<char, char> & from,
+                                                                                                             const std::pair<char, char> & to,
+                                                                                                             const std::map<std::pair<char, char>, char> & gameBoard)
+{
+    auto result = checkMove(player, squareIndex(from), squareIndex(to), toPosition(gameBoard));
+    return { result.first, { squareNames(result.second.first), squareNames(result.second.second) } };
+}
+//Lists the squares a jump from the given square can land on, and the enemy tokens jumped over to get there
+static std::pair<std::vector<int>, std::vector<int>> jumpSquareList(const char & playerPiece,
+                                                                    const int & square,
+                                                                    const Position & position){
+    std::vector<int> output;
+    std::vector<int> jumped;
+    const uint32_t landings = findJumpSquares(playerPiece, square, position);
+    for (int direction = UpRight; direction <= DownLeft; direction++) {
+        int landing = jumpLanding(square, direction);
+        if (landing >= 0 && (landings & squareMask(landing))) {
+            output.push_back(landing);
+            jumped.push_back(neighbour(square, direction));
         }
-        else {
-            if (!current.searched) {
-                //assert(temp.first.size() == temp.second.size());
-                for (unsigned int i = 0; i < temp.first.size(); i++) {
-                    auto el = temp.first.at(i);
-                    current.jumpPoints.push(el);
-                    possibilities.insert(el);
-                    if (el == to) {
-                        path.push_back(el);
-                        jumpedActual.push_back(temp.second.at(i));
-                        pathFound = true;
-                        break;
-                    }
-                }
-                current.searched = true;
-            }
-            if (!current.jumpPoints.empty()) {
-                auto top = current.jumpPoints.top();
-
-                //Cycles through 'tops' that have already been searched
-                while (searchedPossibilities.find(top) != searchedPossibilities.end()) {
-                    if (!current.jumpPoints.empty()) //avoid crash
-                        current.jumpPoints.pop();
-
-                    if (current.jumpPoints.empty()) //avoid crash
-                        break;
-                    else
-                        top = current.jumpPoints.top();
-                }
-            }
-            if (current.jumpPoints.empty()) { //Check if end of the line
-                if (current.fromPtr == nullptr) {
-                    break;
-                }
-                else {
-                    //std::cout << "Tried: " << current.square.first << current.square.second << std::endl;
-                    current = *(current.fromPtr); //return, at end of the line
-                }
-            }
-            else {
-                auto top = current.jumpPoints.top();
-                current.jumpPoints.pop();
-                searchedPossibilities.insert(current.square);
-                current = Node(top, std::make_shared<Node>(current), temp.second.at(current.jumpPoints.size()/*-1 todo */)); //search down the branch
-            }
+    }
+    return { output, jumped };
+}
+//Finds the capture sequence from -> to. Only complete sequences count, ones that can't take any further.
+//Different sequences can join the same two squares, the player only gives the ends, so the one that takes the most tokens is played.
+std::pair<bool, std::pair<std::vector<int>, std::vector<int>>> jumpPathSearch(const int & from,
+                                                                              const int & to,
+                                                                              const Position & position){
+
+    std::vector<int> path{}; //squares jumped to while on way to the "TO" square
+    std::vector<int> jumpedActual{}; //enemy tokens that were jumped over in the process
+
+    MoveList captures;
+    generateCaptures(position, from, captures);
+    int best = -1;
+    for (int i = 0; i < captures.size; i++) {
+        if (captures[i].to == to && (best < 0 || captures[i].jumps > captures[best].jumps))
+            best = i;
+    }
+    const bool pathFound = (best >= 0);
+    if (pathFound) {
+        //Walk back from "TO", as the callers expect
+        const Move & move = captures[best];
+        for (int step = move.jumps - 1; step >= 0; step--) {
+            const int previous = (step == 0) ? move.from : move.path[step - 1];
+            path.push_back(move.path[step]);
+            jumpedActual.push_back(jumpedSquare(previous, move.path[step]));
         }
+        path.push_back(from);
     }
     //returns:
     //  boolean-> was a path found?
-    //  pair   -> vector of points -> squares that the piece jumped to on the way to the finish
-    //  pair   -> vector of points -> enemy pieces squares that were jumped over along the path
+    //  pair   -> vector of squares -> squares that the piece jumped to on the way to the finish
+    //  pair   -> vector of squares -> enemy pieces squares that were jumped over along the path
     return { pathFound,{ path, jumpedActual } };
 }
+std::pair<bool, std::pair<std::vector<std::pair<char, char>>, std::vector<std::pair<char, char>>>> jumpPathSearch(const std::pair<char, char> & from,
+                                                                                                                  const std::pair<char, char> & to,
+                                                                                                                  const std::map<std::pair<char, char>, char> & gameBoard){
+    auto result = jumpPathSearch(squareIndex(from), squareIndex(to), toPosition(gameBoard));
+    return { result.first, { squareNames(result.second.first), squareNames(result.second.second) } };
+}
 
-std::pair< std::vector<std::pair<char, char>>, std::vector<std::pair<char, char>>> findJumpSquares(const char & playerPiece,
-                                                                                                   const std::pair<char, char> & square,
-                                                                                                   const std::map<std::pair<char, char>, char> & gameBoard) {
+//Returns a mask of the squares the piece on the given square can land on with a single jump
+uint32_t findJumpSquares(const char & playerPiece,
+                         const int & square,
+                         const Position & position) {
 
-    //Return vectors
-    std::vector<std::pair<char, char>> output;
-    std::vector<std::pair<char, char>> jumped;
+    const uint32_t empty = ~(position.black | position.white);
 
-    int enemy; //keeps track of which pieces it can jump over legally
+    uint32_t enemy; //keeps track of which pieces it can jump over legally
     if (playerPiece == pieces[Black] || playerPiece == pieces[BlackKing])
-        enemy = White; // 'o'
+        enemy = position.white; // 'o'
     else
-        enemy = Black; // 'x'
-
-    char possibleJumpedPiece;
-
-    if(playerPiece != pieces[White]){ //pieces that can go forward
-        if ((square.first < 'g') && (square.second < '7')) {
-            //Top right square
-            possibleJumpedPiece = gameBoard.at({ square.first + 1, square.second + 1 });
-            if ((possibleJumpedPiece == pieces[enemy]) || (possibleJumpedPiece == pieces[enemy + 1] /*king*/)) {
-                if (gameBoard.find({square.first+2, square.second+2})->second == pieces[Empty]){
-                    output.push_back({ square.first + 2, square.second + 2 });
-                    jumped.push_back({ square.first + 1, square.second + 1 });
-                }
-            }
-        }
-        if ((square.first > 'b') && (square.second < '7')) { //Make sure we are jumping over an enemy piece
-            //Top left square
-            possibleJumpedPiece = gameBoard.at({ square.first - 1, square.second + 1 });
-            if ((possibleJumpedPiece == pieces[enemy]) || (possibleJumpedPiece == pieces[enemy + 1])) {
-                if (gameBoard.find({square.first-2, square.second+2})->second == pieces[Empty]){
-                    output.push_back({ square.first - 2, square.second + 2 });
-                    jumped.push_back({ square.first - 1, square.second + 1 });
-                }
-            }
-        }
-    }
-
-    if(playerPiece != pieces[Black]){ //pieces that can go backward
-        if ((square.first < 'g') && (square.second > '2')) {
-            //Bottom right square
-            possibleJumpedPiece = gameBoard.at({ square.first + 1, square.second - 1 });
-            if ((possibleJumpedPiece == pieces[enemy]) || (possibleJumpedPiece == pieces[enemy + 1])) {
-                if (gameBoard.find({square.first+2, square.second-2})->second == pieces[Empty]){
-                    output.push_back({ square.first + 2, square.second - 2 });
-                    jumped.push_back({ square.first + 1, square.second - 1 });
-                }
-            }
-        }
-
-        if ((square.first > 'b') && (square.second > '2')) {
-            //Bottom left piece
-            possibleJumpedPiece = gameBoard.at({ square.first - 1, square.second - 1 });
-            if ((possibleJumpedPiece == pieces[enemy]) || (possibleJumpedPiece == pieces[enemy + 1])) {
-                if (gameBoard.find({square.first-2, square.second-2})->second == pieces[Empty]){
-                    output.push_back({ square.first - 2, square.second - 2 });
-                    jumped.push_back({square.first - 1, square.second - 1});
-                }
-            }
-        }
+        enemy = position.black; // 'x'
+
+    uint32_t output = 0;
+    for (int direction = UpRight; direction <= DownLeft; direction++) {
+        const bool up = (direction == UpRight || direction == UpLeft);
+        if ((up && playerPiece == pieces[White]) || (!up && playerPiece == pieces[Black]))
+            continue; //tokens only jump forwards
+        const int landing = BB::JUMP[square][direction];
+        if (landing != BB::NO_SQUARE && (enemy & squareMask(BB::NEIGHBOUR[square][direction])))
+            output |= squareMask(landing);
     }
-
-    return { output, jumped };
+    return output & empty;
+}
+std::pair< std::vector<std::pair<char, char>>, std::vector<std::pair<char, char>>> findJumpSquares(const char & playerPiece,
+                                                                                                   const std::pair<char, char> & square,
+                                                                                                   const std::map<std::pair<char, char>, char> & gameBoard) {
+    auto result = jumpSquareList(playerPiece, squareIndex(square), toPosition(gameBoard));
+    return { squareNames(result.first), squareNames(result.second) };
 }
 //Checks to see if the move is a single square away and if it is valid.
 //Alternatively, if findAllSquares is true, returns if there are any valid single square moves.
-bool singleSquareMove(const std::pair<char, char> & from,
-                      const std::pair<char, char> & to,
-                      const std::map<std::pair<char, char>, char> & gameBoard,
+bool singleSquareMove(const int & from,
+                      const int & to,
+                      const Position & position,
                       const bool & findAllSquares /* = false */) {
 
-    char playerPiece = gameBoard.find(from)->second;
-    int amtSquares = 0;
-    if (playerPiece == pieces[Black] || playerPiece == pieces[BlackKing] || playerPiece == pieces[WhiteKing]) { //Pieces that can move up
-        //top right square
-        if(findAllSquares) {
-            auto it = gameBoard.find(std::make_pair(from.first + 1, from.second + 1));
-            if(it != gameBoard.end()){
-                if(it->second == pieces[Empty]){ //if the square is empty
-                    amtSquares++;
-                }
-            }
-        }
-        else if ((from.first + 1) == (to.first)){
-            if ((from.second + 1) == (to.second)){
-                return true;
-            }
-        }
-
-        //top left square
-        if(findAllSquares) {
-            auto it = gameBoard.find(std::make_pair(from.first - 1, from.second + 1));
-            if(it != gameBoard.end()){
-                if(it->second == pieces[Empty]){ //if the square is empty
-                    amtSquares++;
-                }
-            }
-        }
-        else if ((from.first - 1) == (to.first)){
-            if ((from.second + 1) == (to.second)){
-                return true;
-            }
-        }
-    }
-    if (playerPiece == pieces[White] || playerPiece == pieces[BlackKing] || playerPiece == pieces[WhiteKing]) { // Pieces that can move up
-        //bottom left square
-        if(findAllSquares) {
-            auto it = gameBoard.find(std::make_pair(from.first - 1, from.second - 1));
-            if(it != gameBoard.end()){
-                if(it->second == pieces[Empty]){ //if the square is empty
-                    amtSquares++;
-                }
-            }
-        }
-        else if ((from.first - 1) == (to.first)){
-            if ((from.second - 1) == (to.second)){
-                return true;
-            }
-        }
-
-        //bottom right square
-        if(findAllSquares) {
-            auto it = gameBoard.find(std::make_pair(from.first + 1, from.second - 1));
-            if(it != gameBoard.end()){
-                if(it->second == pieces[Empty]){ //if the square is empty
-                    amtSquares++;
-                }
-            }
-        }
-        else if ((from.first + 1) == (to.first)){
-            if ((from.second - 1) == (to.second)){
-                return true;
-            }
-        }
-
+    const char playerPiece = pieceAt(position, from);
+    const bool up = (playerPiece == pieces[Black] || playerPiece == pieces[BlackKing] || playerPiece == pieces[WhiteKing]); //Pieces that can move up
+    const bool down = (playerPiece == pieces[White] || playerPiece == pieces[BlackKing] || playerPiece == pieces[WhiteKing]); //Pieces that can move down
+    uint32_t targets = 0;
+    for (int direction = UpRight; direction <= DownLeft; direction++) {
+        const int target = BB::NEIGHBOUR[from][direction];
+        if (target != BB::NO_SQUARE && ((direction == UpRight || direction == UpLeft) ? up : down))
+            targets |= squareMask(target);
     }
 
     if (!findAllSquares) //If we were searching for a specific move
-        return false; //If the move was not found
+        return (to >= 0) && (targets & squareMask(to));
     else
-        return (amtSquares > 0); //If we were searching for any available move
+        return (targets & ~(position.black | position.white)) != 0; //If we were searching for any available move
+}
+bool singleSquareMove(const std::pair<char, char> & from,
+                      const std::pair<char, char> & to,
+                      const std::map<std::pair<char, char>, char> & gameBoard,
+                      const bool & findAllSquares /* = false */) {
+    const int fromSquare = squareIndex(from);
+    if (fromSquare < 0)
+        return false;
+    return singleSquareMove(fromSquare, squareIndex(to), toPosition(gameBoard), findAllSquares);
 }
 //Overwrites any tokens on the specified square. Used for deleting "jumped over" tokens.
+void removeSquare(const int & square, Position & position) {
+    const int piece = zobristPiece(position, squareMask(square));
+    if (piece >= 0)
+        position.hash ^= zobrist.pieces[piece][square];
+    const uint32_t clear = ~squareMask(square);
+    position.black &= clear;
+    position.white &= clear;
+    position.kings &= clear;
+}
 void removeSquare(const std::pair<char, char> & square, std::map<std::pair<char, char>, char> & gameBoard) {
     gameBoard.at(square) = pieces[Empty];
 }
 //Moves the piece without checking if the move is legal.
+void movePiece(const int & from, const int & to, Position & position) {
+    const uint32_t fromMask = squareMask(from);
+    const uint32_t toMask = squareMask(to);
+    const uint32_t moved = fromMask | toMask;
+    if (from == to) //a king can capture its way around a loop back to where it started
+        return;
+
+    removeSquare(to, position);
+    const int piece = zobristPiece(position, fromMask);
+    if (piece >= 0)
+        position.hash ^= zobrist.pieces[piece][from] ^ zobrist.pieces[piece][to];
+    if (position.black & fromMask)
+        position.black ^= moved;
+    else if (position.white & fromMask)
+        position.white ^= moved;
+    if (position.kings & fromMask)
+        position.kings ^= moved;
+}
 void movePiece(std::pair<char, char> &from,
                std::pair<char, char> &to,
                std::map<std::pair<char, char>, char> & gameBoard) {
@@ -436,37 +406,50 @@ void movePiece(std::pair<char, char> &from,
     gameBoard.at(from) = pieces[Empty];
 }
 //Checks if players have pieces remaining to play
-int win(std::map<std::pair<char, char>, char> & gameBoard, int & playerTurn){
-    if ((findPiecesRemaining(White, gameBoard)).size() == 0) {
-        if ((findPiecesRemaining(Black, gameBoard)).size() == 0){
+int win(const Position & position, const int & playerTurn){
+    if (position.white == 0) {
+        if (position.black == 0){
             return Draw;
         }else{
             return BlackWin;
         }
     }
-    else if ((findPiecesRemaining(Black, gameBoard)).size() == 0) {
+    else if (position.black == 0) {
         return WhiteWin;
     }
-    else if (checkStalemate(playerTurn, gameBoard)) {
-        if(checkStalemate( ((playerTurn == Black) ? White : Black), gameBoard ))
+    else if (checkStalemate(playerTurn, position)) {
+        if(checkStalemate( ((playerTurn == Black) ? White : Black), position ))
             return Draw; //Both are at stalemate
         return ((playerTurn == Black) ? WhiteWin : BlackWin);
     }
     else{
-        return ValidMove;
+        //With endgame tablebases loaded, a won, lost or drawn ending is settled as soon as it is reached
+        switch (probeTablebase(position, playerTurn)) {
+        case TBDraw:
+            return Draw;
+        case TBWin:
+            return ((playerTurn == Black) ? BlackWin : WhiteWin);
+        case TBLoss:
+            return ((playerTurn == Black) ? WhiteWin : BlackWin);
+        default:
+            return ValidMove;
+        }
     }
 }
+int win(std::map<std::pair<char, char>, char> & gameBoard, int & playerTurn){
+    return win(toPosition(gameBoard), playerTurn);
+}
 //Handles the player taking their turn
-int changeTurn(std::map<std::pair<char, char>, char> & gameBoard,
-             std::pair<std::pair<char, char>, std::pair<char, char>> playerMove,
-             int & playerTurn)
+int changeTurn(Position & position,
+               std::pair<int, int> playerMove,
+               int & playerTurn)
 {
-    auto result = checkMove(playerTurn, playerMove.first, playerMove.second, gameBoard);
+    auto result = checkMove(playerTurn, playerMove.first, playerMove.second, position);
 
     if (result.first) { //if the move was legal
-        movePiece(playerMove.first, playerMove.second, gameBoard);
+        movePiece(playerMove.first, playerMove.second, position);
         for (auto el: result.second.second) { //delete any "jumped" tokens
-            removeSquare(el, gameBoard);
+            removeSquare(el, position);
         }
     }
     else {
@@ -479,9 +462,267 @@ int changeTurn(std::map<std::pair<char, char>, char> & gameBoard,
     else
         playerTurn = Black;
 
-    checkCrown(gameBoard);
+    checkCrown(position);
 
-    return win(gameBoard, playerTurn);
+    return win(position, playerTurn);
+}
+int changeTurn(std::map<std::pair<char, char>, char> & gameBoard,
+             std::pair<std::pair<char, char>, std::pair<char, char>> playerMove,
+             int & playerTurn)
+{
+    Position position = toPosition(gameBoard);
+    int result = changeTurn(position, std::make_pair(squareIndex(playerMove.first), squareIndex(playerMove.second)), playerTurn);
+    fromPosition(position, gameBoard);
+    return result;
+}
+//Extends the capture sequence in 'move' from the given square. Each sequence that cannot be extended any further is added to the list.
+//Captured tokens stay on the board until the move is complete, so they can't be jumped twice or landed on.
+static void addCaptures(const int & square,
+                        const bool & king,
+                        const int & side,
+                        const uint32_t & empty,
+                        const uint32_t & enemy,
+                        Move & move,
+                        MoveList & moveList){
+    bool extended = false;
+    for (int direction = UpRight; direction <= DownLeft; direction++) {
+        if (!king && ((side == Black) != (direction == UpRight || direction == UpLeft)))
+            continue; //tokens only capture forwards
+        int over = neighbour(square, direction);
+        if (over < 0 || !(enemy & squareMask(over)) || (move.captured & squareMask(over)))
+            continue;
+        int landing = neighbour(over, direction);
+        if (landing < 0 || !(empty & squareMask(landing)))
+            continue;
+
+        extended = true;
+        move.path[move.jumps++] = uint8_t(landing);
+        move.captured |= squareMask(over);
+
+        const bool crowned = !king && (squareMask(landing) & ((side == Black) ? BB::RANK_8 : BB::RANK_1));
+        if (crowned || move.jumps == MAX_JUMPS) { //reaching the last rank ends the move
+            move.to = uint8_t(landing);
+            moveList.push(move);
+        }
+        else {
+            addCaptures(landing, king, side, empty, enemy, move, moveList);
+        }
+
+        move.captured &= ~squareMask(over);
+        move.jumps--;
+    }
+    if (!extended && move.jumps > 0) {
+        move.to = uint8_t(square);
+        moveList.push(move);
+    }
+}
+//Lists every legal move for the side. Captures are mandatory, so if any capture exists only captures are listed.
+void generateMoves(const Position & position, const int & side, MoveList & moveList){
+    moveList.clear();
+    const uint32_t own = findPiecesRemaining(side, position);
+    const uint32_t enemy = (side == Black) ? position.white : position.black;
+    const uint32_t empty = ~(position.black | position.white);
+
+    Move move;
+    move.jumps = 0;
+    move.captured = 0;
+    for (uint32_t remaining = own; remaining; remaining &= remaining - 1) {
+        const int square = lowestSquare(remaining);
+        move.from = uint8_t(square);
+        addCaptures(square, (position.kings & squareMask(square)) != 0, side, empty | squareMask(square), enemy, move, moveList);
+    }
+    if (moveList.size > 0)
+        return;
+
+    for (uint32_t remaining = own; remaining; remaining &= remaining - 1) {
+        const int square = lowestSquare(remaining);
+        const bool king = (position.kings & squareMask(square)) != 0;
+        for (int direction = UpRight; direction <= DownLeft; direction++) {
+            if (!king && ((side == Black) != (direction == UpRight || direction == UpLeft)))
+                continue; //tokens only move forwards
+            int to = neighbour(square, direction);
+            if (to >= 0 && (empty & squareMask(to))) {
+                move.from = uint8_t(square);
+                move.to = uint8_t(to);
+                moveList.push(move);
+            }
+        }
+    }
+}
+void generateCaptures(const Position & position, const int & from, MoveList & moveList){
+    moveList.clear();
+    const uint32_t fromMask = squareMask(from);
+    if (!((position.black | position.white) & fromMask))
+        return;
+    const int side = (position.black & fromMask) ? Black : White;
+    const uint32_t enemy = (side == Black) ? position.white : position.black;
+    const uint32_t empty = ~(position.black | position.white) | fromMask; //the piece leaves its square, so it can land back on it
+
+    Move move;
+    move.from = uint8_t(from);
+    move.jumps = 0;
+    move.captured = 0;
+    addCaptures(from, (position.kings & fromMask) != 0, side, empty, enemy, move, moveList);
+}
+//Applies a move from generateMoves without checking if it is legal
+void playMove(Position & position, const Move & move){
+    movePiece(move.from, move.to, position);
+    for (uint32_t remaining = move.captured; remaining; remaining &= remaining - 1)
+        removeSquare(lowestSquare(remaining), position);
+    checkCrown(position);
+}
+void makeMove(Position & position, const Move & move, UndoStack & undo){
+    UndoRecord & record = undo.records[undo.size++];
+    const uint32_t fromMask = squareMask(move.from);
+    const uint32_t toMask = squareMask(move.to);
+    const uint32_t moved = (move.from == move.to) ? 0 : (fromMask | toMask); //a king can capture its way back to where it started
+    const bool black = (position.black & fromMask) != 0;
+    const bool king = (position.kings & fromMask) != 0;
+    const int piece = zobristPiece(position, fromMask);
+
+    record.from = move.from;
+    record.to = move.to;
+    record.piece = uint8_t(black ? (king ? BlackKing : Black) : (king ? WhiteKing : White));
+    record.captured = move.captured;
+    record.capturedKings = move.captured & position.kings;
+    record.promoted = !king && (toMask & (black ? BB::RANK_8 : BB::RANK_1));
+
+    uint64_t delta = 0;
+    if (moved)
+        delta ^= zobrist.pieces[piece][move.from] ^ zobrist.pieces[piece][move.to];
+    for (uint32_t remaining = move.captured; remaining; remaining &= remaining - 1) {
+        const int square = lowestSquare(remaining);
+        delta ^= zobrist.pieces[zobristPiece(position, squareMask(square))][square];
+    }
+    if (record.promoted)
+        delta ^= zobrist.pieces[piece][move.to] ^ zobrist.pieces[piece + 1 /*king*/][move.to];
+    record.hashDelta = delta;
+
+    uint32_t & own = black ? position.black : position.white;
+    uint32_t & enemy = black ? position.white : position.black;
+    enemy &= ~move.captured;
+    position.kings &= ~move.captured;
+    own ^= moved;
+    if (king)
+        position.kings ^= moved;
+    else if (record.promoted)
+        position.kings |= toMask;
+    position.hash ^= delta;
+}
+void unmakeMove(Position & position, UndoStack & undo){
+    const UndoRecord & record = undo.records[--undo.size];
+    const uint32_t toMask = squareMask(record.to);
+    const uint32_t moved = (record.from == record.to) ? 0 : (squareMask(record.from) | toMask);
+    const bool black = (record.piece == Black || record.piece == BlackKing);
+
+    uint32_t & own = black ? position.black : position.white;
+    uint32_t & enemy = black ? position.white : position.black;
+    if (record.promoted)
+        position.kings &= ~toMask;
+    else if (record.piece == BlackKing || record.piece == WhiteKing)
+        position.kings ^= moved;
+    own ^= moved;
+    enemy |= record.captured;
+    position.kings |= record.capturedKings;
+    position.hash ^= record.hashDelta;
+}
+//Move in the usual notation, e.g. "c3-d4" or "c3xe5xc7"
+std::string moveName(const Move & move){
+    std::string name;
+    auto from = squareName(move.from);
+    name += from.first;
+    name += from.second;
+    if (move.jumps == 0) {
+        auto to = squareName(move.to);
+        name += '-';
+        name += to.first;
+        name += to.second;
+    }
+    for (int i = 0; i < move.jumps; i++) {
+        auto landing = squareName(move.path[i]);
+        name += 'x';
+        name += landing.first;
+        name += landing.second;
+    }
+    return name;
+}
+//Reads a position in PDN FEN notation, e.g. "W:W21,22,K3:B1-12". Returns false if the string can't be parsed.
+bool readFen(const std::string & fen, Position & position, int & side){
+    std::vector<std::string> fields;
+    std::stringstream stream(fen);
+    std::string field;
+    while (std::getline(stream, field, ':'))
+        fields.push_back(field);
+    if (fields.empty() || fields.at(0).empty())
+        return false;
+
+    if (toupper(fields.at(0).at(0)) == 'W')
+        side = White;
+    else if (toupper(fields.at(0).at(0)) == 'B')
+        side = Black;
+    else
+        return false;
+
+    emptyBoard(position);
+    for (unsigned int i = 1; i < fields.size(); i++) {
+        std::string & list = fields.at(i);
+        while (!list.empty() && (list.back() == '.' || isspace(list.back())))
+            list.pop_back();
+        if (list.empty())
+            continue;
+        uint32_t & colour = (toupper(list.at(0)) == 'W') ? position.white : position.black;
+        if (toupper(list.at(0)) != 'W' && toupper(list.at(0)) != 'B')
+            return false;
+
+        std::stringstream squares(list.substr(1));
+        std::string token;
+        while (std::getline(squares, token, ',')) {
+            if (token.empty())
+                continue;
+            bool king = (toupper(token.at(0)) == 'K');
+            if (king)
+                token.erase(0, 1);
+            int first = 0;
+            int last = 0;
+            try {
+                size_t dash = token.find('-');
+                first = std::stoi(token.substr(0, dash));
+                last = (dash == std::string::npos) ? first : std::stoi(token.substr(dash + 1));
+            }
+            catch (const std::exception &) {
+                return false;
+            }
+            for (int number = first; number <= last; number++) {
+                int square = fromPdnSquare(number);
+                if (square < 0)
+                    return false;
+                colour |= squareMask(square);
+                if (king)
+                    position.kings |= squareMask(square);
+            }
+        }
+    }
+    position.hash = computeHash(position);
+    return (position.black & position.white) == 0;
+}
+std::string writeFen(const Position & position, const int & side){
+    std::string fen = (side == White) ? "W" : "B";
+    for (int colour : { White, Black }) {
+        fen += (colour == White) ? ":W" : ":B";
+        bool first = true;
+        for (int number = 1; number <= 32; number++) {
+            int square = fromPdnSquare(number);
+            if (!(findPiecesRemaining(colour, position) & squareMask(square)))
+                continue;
+            if (!first)
+                fen += ',';
+            if (position.kings & squareMask(square))
+                fen += 'K';
+            fen += std::to_string(number);
+            first = false;
+        }
+    }
+    return fen;
 }
 
 #endif
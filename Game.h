@@ -2,21 +2,19 @@
 #define GAME_H
 
 #include <stdio.h>
-#include <tchar.h>
 #include <ctype.h>
 #include <iostream>
 #include <sstream> 
 #include <iomanip>
 
-#include <stack>
 #include <string>
 #include <vector>
 #include <map>
-#include <set>
 
 #include <exception> 
-#include <stack>
-#include <memory>
+#include <cassert>
+
+#include "Bitboard.h"
 
 typedef enum Move_State{
     InvalidMove = 0,
@@ -36,12 +34,80 @@ typedef enum Pieces_List{
 
 static const std::vector<char> pieces = { '.', 'x', 'X', 'o', 'O' };
 
+static const int MAX_JUMPS = 12; //a side only has 12 tokens that can be taken
+static const int MAX_MOVES = 128; //more than any reachable position has, 12 kings stepping every way make 48.
+                                  //A list that fills up is marked overflowed, and search and perft report it.
+
+//A complete move: a single square step, or a full capture sequence
+struct Move {
+    uint8_t from;
+    uint8_t to;
+    uint8_t jumps; //number of enemy tokens taken, 0 for a single square move
+    uint8_t path[MAX_JUMPS]; //landing square of each jump in order, path[jumps - 1] == to
+    uint32_t captured; //mask of the enemy tokens taken
+};
+
+//Fixed-capacity move list that lives on the stack of the caller
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int size = 0;
+    bool overflowed = false; //a move was dropped because the list was full, so it is incomplete
+
+    void clear(){
+        size = 0;
+        overflowed = false;
+    }
+    void push(const Move & move){
+        assert(size < MAX_MOVES && "more moves than MAX_MOVES, the list would silently lose some");
+        if (size < MAX_MOVES)
+            moves[size++] = move;
+        else
+            overflowed = true;
+    }
+    Move & operator[](const int & index){
+        return moves[index];
+    }
+    const Move & operator[](const int & index) const{
+        return moves[index];
+    }
+};
+
+static const int MAX_UNDO = 1024; //moves an UndoStack can hold, far more than a search goes deep
+
+//What makeMove changed, so unmakeMove can put it back
+struct UndoRecord {
+    uint8_t from;
+    uint8_t to;
+    uint8_t piece; //the moved piece, as a Pieces_List value
+    bool promoted; //the move crowned it
+    uint32_t captured; //enemy tokens taken
+    uint32_t capturedKings; //the kings among them
+    uint64_t hashDelta; //the keys the move changed, xored together
+};
+
+//Fixed-capacity stack of the moves made, one record each, so a position can be walked back without copies
+struct UndoStack {
+    UndoRecord records[MAX_UNDO];
+    int size = 0;
+
+    void clear(){
+        size = 0;
+    }
+    bool empty() const{
+        return size == 0;
+    }
+    bool full() const{
+        return size == MAX_UNDO;
+    }
+};
+
 void emptyBoard(std::map<std::pair<char, char>, char> & gameBoard);
+void customBoardEightPiecesEach(std::map<std::pair<char, char>, char> & gameBoard);
 void boardReset(std::map<std::pair<char, char>, char> & gameBoard);
 
 void showBoard(const std::map<std::pair<char, char>, char> & gameBoard);
 
-std::vector<std::pair<char, char>> findPiecesRemaining(const char& piece, const std::map<std::pair<char, char>, char> & gameBoard);
+std::vector<std::pair<char, char>> findPiecesRemaining(const int & player, const std::map<std::pair<char, char>, char> & gameBoard);
 
 bool checkStalemate(const int & playerTurn, const std::map<std::pair<char, char>, char> & gameBoard);
 
@@ -67,8 +133,10 @@ bool singleSquareMove(const std::pair<char, char> & from,
 
 void printError();
 
-void movePiece(std::pair<char, char> &to,
-               std::pair<char, char> &from,
+void removeSquare(const std::pair<char, char> & square, std::map<std::pair<char, char>, char> & gameBoard);
+
+void movePiece(std::pair<char, char> &from,
+               std::pair<char, char> &to,
                std::map<std::pair<char, char>, char> & gameBoard);
 
 std::pair<std::pair<char, char>, std::pair<char, char>> getUserMove(std::string & prompt);
@@ -78,4 +146,69 @@ int win(std::map<std::pair<char, char>, char> & gameBoard, int & playerTurn);
 int changeTurn(std::map<std::pair<char, char>, char> & gameBoard,
              std::pair<std::pair<char, char>, std::pair<char, char>> playerMove,
              int & playerTurn);
+
+//Bitboard versions of the rules. The std::map functions above are adapters that convert the board and call these.
+Position toPosition(const std::map<std::pair<char, char>, char> & gameBoard);
+void fromPosition(const Position & position, std::map<std::pair<char, char>, char> & gameBoard);
+
+char pieceAt(const Position & position, const int & square);
+
+uint64_t computeHash(const Position & position);
+uint64_t positionKey(const Position & position, const int & side); //hash including the side to move
+
+void emptyBoard(Position & position);
+void customBoardEightPiecesEach(Position & position);
+void boardReset(Position & position);
+
+uint32_t findPiecesRemaining(const int & player, const Position & position);
+
+bool checkStalemate(const int & playerTurn, const Position & position);
+
+void checkCrown(Position & position);
+
+std::pair<bool, std::pair<std::vector<int>, std::vector<int>>> jumpPathSearch(const int & from,
+                                                                              const int & to,
+                                                                              const Position & position);
+
+std::pair<bool, std::pair<std::vector<int>, std::vector<int>>> checkMove(const int & player,
+                                                                         const int & from,
+                                                                         const int & to,
+                                                                         const Position & position);
+
+uint32_t findJumpSquares(const char & playerPiece,
+                         const int & square,
+                         const Position & position);
+
+bool singleSquareMove(const int & from,
+                      const int & to,
+                      const Position & position,
+                      const bool & findAllSquares = false);
+
+void removeSquare(const int & square, Position & position);
+
+void movePiece(const int & from, const int & to, Position & position);
+
+int win(const Position & position, const int & playerTurn);
+
+int changeTurn(Position & position,
+               std::pair<int, int> playerMove,
+               int & playerTurn);
+
+void generateMoves(const Position & position, const int & side, MoveList & moveList);
+//Every capture sequence of the piece on 'from' that can't be extended any further. Sequences may pass through
+//a square, the starting one included, more than once, as long as each token is only taken once.
+//Depth first over a fixed path array and a captured mask, so it never allocates.
+void generateCaptures(const Position & position, const int & from, MoveList & moveList);
+
+void playMove(Position & position, const Move & move);
+//Plays a move from generateMoves in place, crowning included, and pushes what it changed onto the stack.
+//The stack must not be full.
+void makeMove(Position & position, const Move & move, UndoStack & undo);
+//Takes back the last move makeMove pushed, restoring the position exactly, hash included
+void unmakeMove(Position & position, UndoStack & undo);
+
+std::string moveName(const Move & move);
+
+bool readFen(const std::string & fen, Position & position, int & side);
+std::string writeFen(const Position & position, const int & side);
 #endif
@@ -0,0 +1,69 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile(){
+    close();
+}
+
+bool MappedFile::open(const std::string & path, const bool & randomAccess){
+    close();
+#ifdef _WIN32
+    (void)randomAccess;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { //an empty file can't be mapped
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file); //the mapping keeps the file open
+    if (mapping == nullptr)
+        return false;
+    void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); //and the view keeps the mapping
+    if (view == nullptr)
+        return false;
+    length = size_t(size.QuadPart);
+    base = view;
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return false;
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        ::close(descriptor);
+        return false;
+    }
+    void * view = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+    ::close(descriptor); //the mapping keeps the file open
+    if (view == MAP_FAILED)
+        return false;
+    length = size_t(status.st_size);
+    base = view;
+    if (randomAccess)
+        madvise(base, length, MADV_RANDOM);
+#endif
+    return true;
+}
+void MappedFile::close(){
+    if (base != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(base, length);
+#endif
+    }
+    base = nullptr;
+    length = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+
+//A file mapped into memory read only and shared, so every process reading it uses the same page cache.
+//mmap with MAP_SHARED, or CreateFileMapping and MapViewOfFile on Windows.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    bool open(const std::string & path, const bool & randomAccess = false); //randomAccess turns off read-ahead where the OS allows it
+    void close();
+
+    bool isOpen() const{
+        return base != nullptr;
+    }
+    const uint8_t * data() const{
+        return static_cast<const uint8_t *>(base);
+    }
+    size_t size() const{
+        return length;
+    }
+
+private:
+    void * base = nullptr;
+    size_t length = 0;
+};
+
+#endif // MAPPEDFILE_H
@@ -28,7 +28,7 @@ private:
     }
     void dropEvent(QGraphicsSceneDragDropEvent *event){
         event->setAccepted(true);
-        if (event->mimeData()->hasText()){
+        if (event->mimeData()->hasText() && !aiThinking()){
             std::string s = event->mimeData()->text().toStdString();
             redrawBoard(std::make_pair(char(s.at(0)), char(s.at(1))), std::make_pair('z', 'z'), scene()); //invalid square
         }else{
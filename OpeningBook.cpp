@@ -0,0 +1,378 @@
+#include "OpeningBook.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#include "MappedFile.h"
+
+//Layout of a book file: the header, then the entries sorted by key, the moves of one key by weight, best first
+struct BookHeader {
+    char magic[4]; //"CKBK"
+    uint32_t version;
+    uint64_t entries;
+};
+struct BookEntry {
+    uint64_t key; //positionKey of the position the move is played from
+    uint8_t from;
+    uint8_t to;
+    uint16_t reserved;
+    uint32_t captured; //mask of the tokens the move takes
+    uint32_t wins;
+    uint32_t draws;
+    uint32_t losses;
+};
+static const uint32_t BOOK_VERSION = 2; //version 1 entries had no captured mask
+
+static BookMove entryMove(const BookEntry & entry){
+    BookMove move;
+    move.from = entry.from;
+    move.to = entry.to;
+    move.captured = entry.captured;
+    move.wins = entry.wins;
+    move.draws = entry.draws;
+    move.losses = entry.losses;
+    return move;
+}
+
+void OpeningBookBuilder::addGame(const Position & start, const int & side, const std::vector<Move> & gameMoves,
+                                 const int & result, const int & maxPlies){
+    Position position = start;
+    int turn = side;
+    for (int ply = 0; ply < int(gameMoves.size()) && ply < maxPlies; ply++) {
+        const Move & played = gameMoves.at(ply);
+        BookMove & entry = moves[{ positionKey(position, turn), (uint64_t(played.captured) << 10) | (played.from * 32 + played.to) }];
+        entry.from = played.from;
+        entry.to = played.to;
+        entry.captured = played.captured;
+        if (result == Draw)
+            entry.draws++;
+        else if ((result == WhiteWin) == (turn == White))
+            entry.wins++;
+        else
+            entry.losses++;
+        playMove(position, played);
+        turn = (turn == White) ? Black : White;
+    }
+}
+void OpeningBookBuilder::merge(const OpeningBookBuilder & other){
+    for (auto & entry : other.moves) {
+        BookMove & move = moves[entry.first];
+        move.from = entry.second.from;
+        move.to = entry.second.to;
+        move.captured = entry.second.captured;
+        move.wins += entry.second.wins;
+        move.draws += entry.second.draws;
+        move.losses += entry.second.losses;
+    }
+}
+int64_t OpeningBookBuilder::write(const std::string & path, const uint32_t & minGames) const{
+    std::vector<BookEntry> entries;
+    for (auto & entry : moves) {
+        if (entry.second.games() < minGames)
+            continue;
+        BookEntry written;
+        written.key = entry.first.first;
+        written.from = uint8_t(entry.second.from);
+        written.to = uint8_t(entry.second.to);
+        written.reserved = 0;
+        written.captured = entry.second.captured;
+        written.wins = entry.second.wins;
+        written.draws = entry.second.draws;
+        written.losses = entry.second.losses;
+        entries.push_back(written);
+    }
+    std::sort(entries.begin(), entries.end(), [](const BookEntry & a, const BookEntry & b){
+        if (a.key != b.key)
+            return a.key < b.key;
+        return entryMove(a).weight() > entryMove(b).weight();
+    });
+
+    BookHeader header;
+    std::memcpy(header.magic, "CKBK", 4);
+    header.version = BOOK_VERSION;
+    header.entries = entries.size();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(BookEntry));
+    return file ? int64_t(entries.size()) : -1;
+}
+
+//PDN reading. Only what a book needs: the FEN and Result tags and the moves of the main line.
+struct PdnGame {
+    std::map<std::string, std::string> tags;
+    std::vector<std::string> moves;
+    std::string result;
+};
+
+static bool isResult(const std::string & token){
+    return token == "1-0" || token == "0-1" || token == "2-0" || token == "0-2"
+            || token == "1/2-1/2" || token == "1-1" || token == "*";
+}
+//Move text such as "11-15", "22x15" or "15x24x31", with any move number and annotation marks taken off
+static std::string moveToken(std::string token){
+    size_t dot = token.find_last_of('.');
+    if (dot != std::string::npos)
+        token.erase(0, dot + 1);
+    while (!token.empty() && (token.back() == '!' || token.back() == '?' || token.back() == '+'))
+        token.pop_back();
+    if (token.empty() || !isdigit(static_cast<unsigned char>(token.front())) || !isdigit(static_cast<unsigned char>(token.back())))
+        return "";
+    for (char c : token)
+        if (!isdigit(static_cast<unsigned char>(c)) && c != '-' && c != 'x' && c != 'X')
+            return "";
+    return token;
+}
+
+//Splits the file into games, dropping comments, variations and NAGs
+static std::vector<PdnGame> readPdnGames(std::istream & input){
+    std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    std::vector<PdnGame> games;
+    PdnGame game;
+    auto finishGame = [&](){
+        if (!game.moves.empty() || !game.result.empty())
+            games.push_back(game);
+        game = PdnGame();
+    };
+
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text.at(i);
+        if (isspace(static_cast<unsigned char>(c))) {
+            i++;
+        }
+        else if (c == '[') { //tag pair: [Name "value"]
+            if (!game.moves.empty() || !game.result.empty())
+                finishGame(); //tags after moves start the next game
+            size_t end = text.find(']', i);
+            if (end == std::string::npos)
+                break;
+            std::string tag = text.substr(i + 1, end - i - 1);
+            size_t firstQuote = tag.find('"');
+            size_t lastQuote = tag.rfind('"');
+            if (firstQuote != std::string::npos && lastQuote > firstQuote) {
+                std::string name = tag.substr(0, firstQuote);
+                name.erase(std::remove_if(name.begin(), name.end(), [](char ch){ return isspace(static_cast<unsigned char>(ch)); }), name.end());
+                game.tags[name] = tag.substr(firstQuote + 1, lastQuote - firstQuote - 1);
+            }
+            i = end + 1;
+        }
+        else if (c == '{') {
+            size_t end = text.find('}', i);
+            i = (end == std::string::npos) ? text.size() : end + 1;
+        }
+        else if (c == ';') {
+            size_t end = text.find('\n', i);
+            i = (end == std::string::npos) ? text.size() : end + 1;
+        }
+        else if (c == '(') {
+            int nesting = 0;
+            for (; i < text.size(); i++) {
+                if (text.at(i) == '(')
+                    nesting++;
+                else if (text.at(i) == ')' && --nesting == 0)
+                    break;
+            }
+            i++;
+        }
+        else {
+            size_t end = i;
+            while (end < text.size() && !isspace(static_cast<unsigned char>(text.at(end))) && text.at(end) != '{'
+                   && text.at(end) != '(' && text.at(end) != '[' && text.at(end) != ';')
+                end++;
+            std::string token = text.substr(i, end - i);
+            i = end;
+            if (isResult(token)) {
+                game.result = token;
+                finishGame();
+            }
+            else if (!moveToken(token).empty()) {
+                game.moves.push_back(moveToken(token));
+            }
+        }
+    }
+    finishGame();
+    return games;
+}
+
+//The legal move the text names. A capture may give every landing square or only the first and last.
+static bool findPdnMove(const Position & position, const int & side, const std::string & token, Move & found){
+    std::vector<int> squares;
+    std::string number;
+    for (char c : token + "-") {
+        if (isdigit(static_cast<unsigned char>(c))) {
+            number += c;
+            continue;
+        }
+        if (number.empty())
+            return false;
+        int square = fromPdnSquare(std::stoi(number));
+        if (square < 0)
+            return false;
+        squares.push_back(square);
+        number.clear();
+    }
+    if (squares.size() < 2)
+        return false;
+
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+    for (int i = 0; i < moveList.size; i++) {
+        const Move & move = moveList[i];
+        if (move.from != squares.front() || move.to != squares.back())
+            continue;
+        bool samePath = (squares.size() == 2);
+        if (!samePath && int(squares.size()) == move.jumps + 1) {
+            samePath = true;
+            for (int jump = 0; jump < move.jumps; jump++)
+                samePath = samePath && (move.path[jump] == squares.at(jump + 1));
+        }
+        if (samePath) {
+            found = move;
+            return true;
+        }
+    }
+    return false;
+}
+
+int importPdn(std::istream & input, OpeningBookBuilder & builder, const int & maxPlies){
+    int imported = 0;
+    for (auto & game : readPdnGames(input)) {
+        if (game.result.empty() || game.result == "*") {
+            auto tag = game.tags.find("Result");
+            game.result = (tag != game.tags.end()) ? tag->second : "*";
+        }
+        if (game.result == "*" || !isResult(game.result) || game.moves.empty())
+            continue;
+
+        Position start;
+        int side = White;
+        auto fen = game.tags.find("FEN");
+        if (fen != game.tags.end()) {
+            if (!readFen(fen->second, start, side))
+                continue;
+        }
+        else {
+            boardReset(start);
+            //Standard English draughts records have the side on 1-12 moving first, this board has White.
+            //Whoever owns the first move's square is the one to move.
+            int first = fromPdnSquare(std::atoi(game.moves.front().c_str()));
+            side = (first >= 0 && (start.black & squareMask(first))) ? Black : White;
+        }
+
+        Position position = start;
+        int turn = side;
+        std::vector<Move> moves;
+        for (auto & token : game.moves) {
+            Move move;
+            if (!findPdnMove(position, turn, token, move))
+                break;
+            moves.push_back(move);
+            playMove(position, move);
+            turn = (turn == White) ? Black : White;
+        }
+        if (moves.empty())
+            continue;
+
+        const int firstMover = side;
+        const int secondMover = (side == White) ? Black : White;
+        int result = Draw;
+        if (game.result == "1-0" || game.result == "2-0")
+            result = (firstMover == White) ? WhiteWin : BlackWin;
+        else if (game.result == "0-1" || game.result == "0-2")
+            result = (secondMover == White) ? WhiteWin : BlackWin;
+        builder.addGame(start, side, moves, result, maxPlies);
+        imported++;
+    }
+    return imported;
+}
+
+//The book being probed
+static MappedFile bookFile;
+static const BookEntry * bookEntries = nullptr;
+static uint64_t bookEntryCount = 0;
+
+bool loadOpeningBook(const std::string & path){
+    unloadOpeningBook();
+    if (!bookFile.open(path, true) || bookFile.size() < sizeof(BookHeader))
+        return false;
+    BookHeader header;
+    std::memcpy(&header, bookFile.data(), sizeof(header));
+    if (std::memcmp(header.magic, "CKBK", 4) != 0 || header.version != BOOK_VERSION
+            || bookFile.size() < sizeof(header) + header.entries * sizeof(BookEntry)) {
+        std::cout << "Ignoring damaged or out of date opening book " << path << std::endl;
+        bookFile.close();
+        return false;
+    }
+    bookEntries = reinterpret_cast<const BookEntry *>(bookFile.data() + sizeof(header));
+    bookEntryCount = header.entries;
+    return true;
+}
+void unloadOpeningBook(){
+    bookFile.close();
+    bookEntries = nullptr;
+    bookEntryCount = 0;
+}
+bool openingBookLoaded(){
+    return bookEntryCount > 0;
+}
+
+int probeOpeningBook(const Position & position, const int & side, BookMove * moves, const int & maxMoves){
+    if (bookEntryCount == 0)
+        return 0;
+    const uint64_t key = positionKey(position, side);
+    const BookEntry * end = bookEntries + bookEntryCount;
+    const BookEntry * entry = std::lower_bound(bookEntries, end, key, [](const BookEntry & a, const uint64_t & b){
+        return a.key < b;
+    });
+    int count = 0;
+    for (; entry != end && entry->key == key && count < maxMoves; entry++)
+        moves[count++] = entryMove(*entry);
+    return count;
+}
+bool pickBookMove(const Position & position, const int & side, Move & move, std::mt19937 & random){
+    BookMove bookMoves[MAX_BOOK_MOVES];
+    const int count = probeOpeningBook(position, side, bookMoves);
+    if (count == 0)
+        return false;
+
+    //A key collision could hand back moves from another position, so only legal ones are kept
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+    Move candidates[MAX_BOOK_MOVES];
+    uint32_t weights[MAX_BOOK_MOVES];
+    int candidateCount = 0;
+    uint64_t total = 0;
+    for (int i = 0; i < count; i++) {
+        if (bookMoves[i].weight() == 0)
+            continue;
+        for (int j = 0; j < moveList.size; j++) {
+            if (moveList[j].from == bookMoves[i].from && moveList[j].to == bookMoves[i].to
+                    && moveList[j].captured == bookMoves[i].captured) {
+                candidates[candidateCount] = moveList[j];
+                weights[candidateCount++] = bookMoves[i].weight();
+                total += bookMoves[i].weight();
+                break;
+            }
+        }
+    }
+    if (candidateCount == 0)
+        return false;
+
+    uint64_t pick = std::uniform_int_distribution<uint64_t>(0, total - 1)(random);
+    for (int i = 0; i < candidateCount; i++) {
+        if (pick < weights[i]) {
+            move = candidates[i];
+            return true;
+        }
+        pick -= weights[i];
+    }
+    move = candidates[candidateCount - 1];
+    return true;
+}
+bool pickBookMove(const Position & position, const int & side, Move & move){
+    thread_local std::mt19937 random{std::random_device{}()}; //searches run on worker threads, so each has its own
+    return pickBookMove(position, side, move, random);
+}
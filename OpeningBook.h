@@ -0,0 +1,72 @@
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include <stdint.h>
+
+#include <istream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+
+static const int MAX_BOOK_MOVES = 32; //most moves of one position probeOpeningBook returns
+
+//A move of a book position and the results of the games that played it, for the side that played it
+struct BookMove {
+    int from = -1;
+    int to = -1;
+    uint32_t captured = 0; //tokens a capture takes, so two capture routes between the same squares stay apart
+    uint32_t wins = 0;
+    uint32_t draws = 0;
+    uint32_t losses = 0;
+
+    uint32_t games() const{
+        return wins + draws + losses;
+    }
+    uint32_t weight() const{ //half points scored, how likely the move is to be picked
+        return 2 * wins + draws;
+    }
+};
+
+//Adds up the moves of finished games, position by position, and writes them out as a book file.
+//Positions are keyed by positionKey, so transpositions share their entries.
+class OpeningBookBuilder
+{
+public:
+    //result is WhiteWin, BlackWin or Draw. Only the first maxPlies moves go into the book.
+    void addGame(const Position & start, const int & side, const std::vector<Move> & moves,
+                 const int & result, const int & maxPlies);
+    void merge(const OpeningBookBuilder & other);
+
+    size_t entries() const{
+        return moves.size();
+    }
+    //Moves played in fewer than minGames games are left out. Returns the number of entries written, -1 on error.
+    int64_t write(const std::string & path, const uint32_t & minGames = 1) const;
+
+private:
+    std::map<std::pair<uint64_t, uint64_t>, BookMove> moves; //position key, and the captured mask over from * 32 + to
+};
+
+//Reads the games of a PDN file into the builder. Games without a result, or that start from a position
+//that can't be read, are skipped, and a game stops at the first move that isn't legal.
+//Scores in the Result tag are for the side that moves first, so "1-0" is a win for it.
+//Returns the number of games added.
+int importPdn(std::istream & input, OpeningBookBuilder & builder, const int & maxPlies);
+
+//Maps a book file read only and shared. Loading and unloading must not happen while anything is probing.
+bool loadOpeningBook(const std::string & path);
+void unloadOpeningBook();
+bool openingBookLoaded();
+
+//Book moves of the position, best weighted first. Returns how many were put in 'moves'.
+int probeOpeningBook(const Position & position, const int & side, BookMove * moves, const int & maxMoves = MAX_BOOK_MOVES);
+//Picks one of the position's legal book moves at random, in proportion to their weights.
+//False if the position isn't in the book or none of its moves ever scored.
+bool pickBookMove(const Position & position, const int & side, Move & move, std::mt19937 & random);
+//Same, drawing from a generator of the calling thread seeded from std::random_device
+bool pickBookMove(const Position & position, const int & side, Move & move);
+
+#endif // OPENINGBOOK_H
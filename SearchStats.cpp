@@ -0,0 +1,81 @@
+#include "SearchStats.h"
+
+#include <iomanip>
+#include <sstream>
+
+void SearchStats::add(const SearchStats & other){
+    nodes += other.nodes;
+    qnodes += other.qnodes;
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    ttCutoffs += other.ttCutoffs;
+    tbHits += other.tbHits;
+    betaCutoffs += other.betaCutoffs;
+    moveListOverflows += other.moveListOverflows;
+    for (int i = 0; i < CUTOFF_SLOTS; i++)
+        cutoffs[i] += other.cutoffs[i];
+}
+double SearchStats::ttHitRate() const{
+    return (ttProbes > 0) ? double(ttHits) / ttProbes : 0.0;
+}
+double SearchStats::firstMoveCutoffRate() const{
+    return (betaCutoffs > 0) ? double(cutoffs[0]) / betaCutoffs : 0.0;
+}
+double SearchStats::branchingFactor() const{
+    if (iterationCount < 2 || iterations[iterationCount - 2].nodes == 0)
+        return 0.0;
+    return double(iterations[iterationCount - 1].nodes) / iterations[iterationCount - 2].nodes;
+}
+uint64_t SearchStats::nodesPerSecond() const{
+    return (timeMs > 0) ? (nodes + qnodes) * 1000 / timeMs : 0;
+}
+
+std::string statsJson(const SearchStats & stats){
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+    json << "{\"nodes\":" << stats.nodes
+         << ",\"qnodes\":" << stats.qnodes
+         << ",\"time_ms\":" << stats.timeMs
+         << ",\"nps\":" << stats.nodesPerSecond()
+         << ",\"tt_probes\":" << stats.ttProbes
+         << ",\"tt_hits\":" << stats.ttHits
+         << ",\"tt_hit_rate\":" << stats.ttHitRate()
+         << ",\"tt_cutoffs\":" << stats.ttCutoffs
+         << ",\"tb_hits\":" << stats.tbHits
+         << ",\"beta_cutoffs\":" << stats.betaCutoffs
+         << ",\"move_list_overflows\":" << stats.moveListOverflows
+         << ",\"first_move_cutoff_rate\":" << stats.firstMoveCutoffRate()
+         << ",\"cutoff_histogram\":[";
+    for (int i = 0; i < CUTOFF_SLOTS; i++)
+        json << (i > 0 ? "," : "") << stats.cutoffs[i];
+    json << "],\"branching_factor\":" << stats.branchingFactor()
+         << ",\"iterations\":[";
+    for (int i = 0; i < stats.iterationCount; i++) {
+        json << (i > 0 ? "," : "") << "{\"depth\":" << stats.iterations[i].depth
+             << ",\"nodes\":" << stats.iterations[i].nodes
+             << ",\"time_ms\":" << stats.iterations[i].timeMs << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+std::string statsText(const SearchStats & stats){
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1);
+    text << "Nodes: " << stats.nodes << "\n"
+         << "Quiescence nodes: " << stats.qnodes << "\n"
+         << "Time: " << stats.timeMs << " ms\n"
+         << "Nodes/sec: " << stats.nodesPerSecond() << "\n"
+         << "TT hit rate: " << 100.0 * stats.ttHitRate() << "%\n"
+         << "Tablebase hits: " << stats.tbHits << "\n"
+         << "First move cutoffs: " << 100.0 * stats.firstMoveCutoffRate() << "%\n"
+         << std::setprecision(2) << "Branching factor: " << stats.branchingFactor() << "\n"
+         << "Cutoffs by move:";
+    for (int i = 0; i < CUTOFF_SLOTS; i++)
+        text << " " << stats.cutoffs[i];
+    if (stats.moveListOverflows > 0)
+        text << "\nMove list overflows: " << stats.moveListOverflows;
+    text << "\nIterations:\n";
+    for (int i = 0; i < stats.iterationCount; i++)
+        text << "  depth " << stats.iterations[i].depth << ": " << stats.iterations[i].nodes << " nodes, " << stats.iterations[i].timeMs << " ms\n";
+    return text.str();
+}
@@ -0,0 +1,46 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include <stdint.h>
+
+#include <string>
+
+static const int MAX_ITERATIONS = 128; //one per ply of iterative deepening
+static const int CUTOFF_SLOTS = 8; //beta cutoff histogram buckets, the last one holds every later move
+
+struct IterationStats {
+    int depth = 0;
+    uint64_t nodes = 0; //nodes of this iteration alone
+    int timeMs = 0; //time this iteration took
+};
+
+//What a search did. Each search thread counts into its own copy and they are added up when the search ends.
+struct SearchStats {
+    uint64_t nodes = 0; //alpha-beta nodes
+    uint64_t qnodes = 0; //quiescence nodes
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0; //probes that found the position
+    uint64_t ttCutoffs = 0; //hits whose score settled the node straight away
+    uint64_t tbHits = 0; //positions settled by an endgame tablebase
+    uint64_t betaCutoffs = 0;
+    uint64_t moveListOverflows = 0; //positions with more moves than a MoveList holds, so some went unsearched
+    uint64_t cutoffs[CUTOFF_SLOTS] = {}; //beta cutoffs by the position of the move that caused them in the move order
+    int timeMs = 0;
+
+    int iterationCount = 0; //iterations completed by the main thread
+    IterationStats iterations[MAX_ITERATIONS];
+
+    void add(const SearchStats & other); //counters only, the iterations belong to the main thread
+
+    double ttHitRate() const;
+    double firstMoveCutoffRate() const; //share of beta cutoffs caused by the first move searched
+    double branchingFactor() const; //nodes of the last iteration over nodes of the one before it
+    uint64_t nodesPerSecond() const;
+};
+
+//One line of JSON, for dashboards and logs
+std::string statsJson(const SearchStats & stats);
+//A few lines of text, for the GUI
+std::string statsText(const SearchStats & stats);
+
+#endif // SEARCHSTATS_H
@@ -0,0 +1,118 @@
+#include "SearchTrace.h"
+
+#include <chrono>
+
+static SearchTrace trace;
+
+SearchTrace & searchTrace(){
+    return trace;
+}
+
+SearchTrace::~SearchTrace(){
+    stop();
+}
+bool SearchTrace::start(const std::string & path, const size_t & capacity){
+    stop();
+    file.open(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    size_t count = 2;
+    while (count < capacity)
+        count *= 2; //power of two, so a cell is found with a mask
+    cells.reset(new Cell[count]);
+    for (size_t i = 0; i < count; i++)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    mask = count - 1;
+    enqueuePosition.store(0, std::memory_order_relaxed);
+    dequeuePosition.store(0, std::memory_order_relaxed);
+    droppedRecords.store(0, std::memory_order_relaxed);
+
+    running.store(true, std::memory_order_release);
+    writer = std::thread(&SearchTrace::writerLoop, this);
+    return true;
+}
+void SearchTrace::stop(){
+    if (!running.exchange(false))
+        return;
+    writer.join(); //the writer empties the buffer before it returns
+    file.close();
+}
+bool SearchTrace::push(const TraceRecord & record){
+    if (!enabled())
+        return false;
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    Cell * cell = nullptr;
+    while (true) {
+        cell = &cells[position & mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t difference = intptr_t(sequence) - intptr_t(position);
+        if (difference == 0) { //the cell is free, try to claim it
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0) { //the writer hasn't emptied it yet, the buffer is full
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+    cell->record = record;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+bool SearchTrace::pop(TraceRecord & record){
+    size_t position = dequeuePosition.load(std::memory_order_relaxed);
+    Cell * cell = nullptr;
+    while (true) {
+        cell = &cells[position & mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t difference = intptr_t(sequence) - intptr_t(position + 1);
+        if (difference == 0) { //a record is ready, try to claim it
+            if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0) { //nothing has been written there yet
+            return false;
+        }
+        else {
+            position = dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+    record = cell->record;
+    cell->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+}
+uint64_t SearchTrace::dropped() const{
+    return droppedRecords.load(std::memory_order_relaxed);
+}
+void SearchTrace::writeRecord(const TraceRecord & record){
+    file << "{\"type\":\"" << ((record.type == TraceResult) ? "result" : "iteration") << "\""
+         << ",\"thread\":" << record.thread
+         << ",\"fen\":\"" << writeFen(record.position, record.side) << "\""
+         << ",\"key\":" << positionKey(record.position, record.side)
+         << ",\"depth\":" << record.depth
+         << ",\"score\":" << record.score
+         << ",\"nodes\":" << record.nodes
+         << ",\"time_ms\":" << record.timeMs
+         << ",\"move\":\"" << moveName(record.bestMove) << "\"}\n";
+}
+void SearchTrace::writerLoop(){
+    TraceRecord record;
+    while (running.load(std::memory_order_acquire)) {
+        bool wrote = false;
+        while (pop(record)) {
+            writeRecord(record);
+            wrote = true;
+        }
+        if (wrote)
+            file.flush();
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    while (pop(record)) //records pushed before stop() was called
+        writeRecord(record);
+    file.flush();
+}
@@ -0,0 +1,78 @@
+#ifndef SEARCHTRACE_H
+#define SEARCHTRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Game.h"
+
+typedef enum Trace_Type{
+    TraceIteration = 0, //a search thread finished an iteration
+    TraceResult         //the move a search settled on
+}Trace_Type;
+
+//One line of the trace. Plain data, so it can be copied through the ring buffer.
+struct TraceRecord {
+    int type = TraceIteration;
+    int thread = 0;
+    Position position; //the searched position
+    int side = White;
+    int depth = 0;
+    int score = 0;
+    uint64_t nodes = 0;
+    int timeMs = 0;
+    Move bestMove = Move();
+};
+
+//Opt-in log of what the search did, written as one JSON object per line.
+//Search threads push records into a fixed lock-free ring buffer (bounded MPMC, one sequence number per cell)
+//and a background thread formats and writes them, so the search never waits on the file.
+//Records are dropped rather than blocking when the writer falls behind.
+//While it is not started, enabled() is a single relaxed load and nothing else is done.
+//start and stop must not be called while a search is running.
+class SearchTrace
+{
+public:
+    SearchTrace() = default;
+    ~SearchTrace();
+
+    bool start(const std::string & path, const size_t & capacity = 4096); //capacity is rounded up to a power of two
+    void stop(); //writes whatever is still buffered and closes the file
+
+    bool enabled() const{
+        return running.load(std::memory_order_relaxed);
+    }
+    bool push(const TraceRecord & record); //false if the buffer was full and the record was dropped
+    uint64_t dropped() const;
+
+private:
+    bool pop(TraceRecord & record);
+    void writeRecord(const TraceRecord & record);
+    void writerLoop();
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        TraceRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) std::atomic<size_t> dequeuePosition{0};
+    std::atomic<uint64_t> droppedRecords{0};
+
+    std::atomic<bool> running{false};
+    std::thread writer;
+    std::ofstream file;
+};
+
+//Trace the search writes to
+SearchTrace & searchTrace();
+
+#endif // SEARCHTRACE_H
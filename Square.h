@@ -48,7 +48,7 @@ private:
     void dropEvent(QGraphicsSceneDragDropEvent *event){
         dragOver = false;
         event->setAccepted(true);
-        if (event->mimeData()->hasText()){
+        if (event->mimeData()->hasText() && !aiThinking()){
             std::string s = event->mimeData()->text().toStdString();
             redrawBoard(std::make_pair(char(s.at(0)), char(s.at(1))), square, scene());
         }else{
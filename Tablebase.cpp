@@ -0,0 +1,551 @@
+#include "Tablebase.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "MappedFile.h"
+
+//Layout of a table file:
+//  the header
+//  the block index, blockCount + 1 offsets into the block data, so block n is the bytes from offset n to offset n + 1
+//  the block data. Each block holds blockPositions values, run-length coded one run to a byte: bits 0-1 are the
+//  value and bits 2-7 the length less one. A length field of 63 is followed by a varint with the rest of the length.
+struct TablebaseHeader {
+    char magic[4]; //"CKTB"
+    uint32_t version;
+    uint8_t blackMen, blackKings, whiteMen, whiteKings;
+    uint32_t blockPositions;
+    uint64_t positions;
+    uint64_t blockCount;
+};
+static const uint32_t TB_VERSION = 2;
+static const uint32_t TB_BLOCK_POSITIONS = 16384; //4 kB once unpacked to 2 bits a value
+static const int CACHE_SHARDS = 16; //the block cache is split so search threads rarely wait on each other
+
+static const int MEN_SQUARES = 28; //a man never stands on the rank it crowns on
+
+//Pascal's triangle, binomials[n][k] = n choose k
+static struct Binomials {
+    uint64_t value[33][33];
+    Binomials(){
+        for (int n = 0; n <= 32; n++) {
+            value[n][0] = 1;
+            for (int k = 1; k <= 32; k++)
+                value[n][k] = (n == 0) ? 0 : value[n - 1][k - 1] + value[n - 1][k];
+        }
+    }
+} binomials;
+
+static uint64_t choose(const int & n, const int & k){
+    return (n < 0 || k < 0 || k > n) ? 0 : binomials.value[n][k];
+}
+
+//Colex rank of the set bits of a mask
+static uint64_t colexRank(uint32_t mask){
+    uint64_t rank = 0;
+    for (int i = 1; mask; mask &= mask - 1, i++)
+        rank += choose(lowestSquare(mask), i);
+    return rank;
+}
+static uint32_t colexUnrank(uint64_t rank, const int & count){
+    uint32_t mask = 0;
+    int bit = 31;
+    for (int i = count; i >= 1; i--) {
+        while (choose(bit, i) > rank)
+            bit--;
+        rank -= choose(bit, i);
+        mask |= squareMask(bit);
+        bit--;
+    }
+    return mask;
+}
+//The squares of 'mask' numbered by their place among the squares of 'free', and back again
+static uint32_t compressSquares(uint32_t mask, const uint32_t & free){
+    uint32_t compressed = 0;
+    for (; mask; mask &= mask - 1)
+        compressed |= squareMask(bitCount(free & (squareMask(lowestSquare(mask)) - 1)));
+    return compressed;
+}
+static uint32_t expandSquares(uint32_t compressed, const uint32_t & free){
+    uint32_t mask = 0;
+    int place = 0;
+    for (uint32_t remaining = free; remaining && compressed; remaining &= remaining - 1, place++) {
+        if (compressed & squareMask(place)) {
+            mask |= squareMask(lowestSquare(remaining));
+            compressed &= ~squareMask(place);
+        }
+    }
+    return mask;
+}
+
+//The same position seen from the other side: the board turned round and the colours swapped
+static Position flipPosition(const Position & position){
+    Position flipped;
+    flipped.black = flipMask(position.white);
+    flipped.white = flipMask(position.black);
+    flipped.kings = flipMask(position.kings);
+    return flipped;
+}
+
+static int sliceKey(const TablebaseSlice & slice){
+    return slice.blackMen | (slice.blackKings << 4) | (slice.whiteMen << 8) | (slice.whiteKings << 12);
+}
+static int slicePieces(const TablebaseSlice & slice){
+    return slice.blackMen + slice.blackKings + slice.whiteMen + slice.whiteKings;
+}
+
+uint64_t tablebaseSize(const TablebaseSlice & slice){
+    const int menFree = 32 - slice.blackMen - slice.whiteMen;
+    return choose(MEN_SQUARES, slice.blackMen) * choose(MEN_SQUARES, slice.whiteMen)
+            * choose(menFree, slice.blackKings) * choose(menFree - slice.blackKings, slice.whiteKings);
+}
+bool tablebaseIndex(const Position & position, TablebaseSlice & slice, uint64_t & index){
+    const uint32_t blackMen = position.black & ~position.kings;
+    const uint32_t whiteMen = position.white & ~position.kings;
+    const uint32_t blackKings = position.black & position.kings;
+    const uint32_t whiteKings = position.white & position.kings;
+    if ((blackMen & BB::RANK_8) || (whiteMen & BB::RANK_1))
+        return false; //should have been crowned
+    slice.blackMen = bitCount(blackMen);
+    slice.blackKings = bitCount(blackKings);
+    slice.whiteMen = bitCount(whiteMen);
+    slice.whiteKings = bitCount(whiteKings);
+    if (slicePieces(slice) > TB_MAX_PIECES)
+        return false;
+
+    const uint32_t menFree = ~(blackMen | whiteMen);
+    const uint32_t kingsFree = menFree & ~blackKings;
+    const int menFreeCount = 32 - slice.blackMen - slice.whiteMen;
+    index = colexRank(blackMen);
+    index = index * choose(MEN_SQUARES, slice.whiteMen) + colexRank(whiteMen >> 4);
+    index = index * choose(menFreeCount, slice.blackKings) + colexRank(compressSquares(blackKings, menFree));
+    index = index * choose(menFreeCount - slice.blackKings, slice.whiteKings) + colexRank(compressSquares(whiteKings, kingsFree));
+    return true;
+}
+bool tablebasePosition(const TablebaseSlice & slice, const uint64_t & index, Position & position){
+    const int menFreeCount = 32 - slice.blackMen - slice.whiteMen;
+    uint64_t remaining = index;
+    const uint64_t whiteKingsRadix = choose(menFreeCount - slice.blackKings, slice.whiteKings);
+    const uint64_t whiteKingsRank = remaining % whiteKingsRadix;
+    remaining /= whiteKingsRadix;
+    const uint64_t blackKingsRadix = choose(menFreeCount, slice.blackKings);
+    const uint64_t blackKingsRank = remaining % blackKingsRadix;
+    remaining /= blackKingsRadix;
+    const uint64_t whiteMenRadix = choose(MEN_SQUARES, slice.whiteMen);
+    const uint64_t whiteMenRank = remaining % whiteMenRadix;
+    remaining /= whiteMenRadix;
+
+    const uint32_t blackMen = colexUnrank(remaining, slice.blackMen);
+    const uint32_t whiteMen = colexUnrank(whiteMenRank, slice.whiteMen) << 4;
+    if (blackMen & whiteMen)
+        return false;
+    const uint32_t menFree = ~(blackMen | whiteMen);
+    const uint32_t blackKings = expandSquares(colexUnrank(blackKingsRank, slice.blackKings), menFree);
+    const uint32_t whiteKings = expandSquares(colexUnrank(whiteKingsRank, slice.whiteKings), menFree & ~blackKings);
+
+    position.black = blackMen | blackKings;
+    position.white = whiteMen | whiteKings;
+    position.kings = blackKings | whiteKings;
+    position.hash = computeHash(position);
+    return true;
+}
+std::string tablebaseFileName(const TablebaseSlice & slice){
+    return "tb_" + std::to_string(slice.blackMen) + std::to_string(slice.blackKings)
+            + std::to_string(slice.whiteMen) + std::to_string(slice.whiteKings) + ".wld";
+}
+
+//Value of a packed entry, four to a byte, lowest bits first
+static int packedValue(const uint8_t * data, const uint64_t & index){
+    return (data[index >> 2] >> ((index & 3) * 2)) & 3;
+}
+
+//A mapped table file and where its parts are
+struct MappedTable {
+    int key = 0;
+    uint64_t positions = 0;
+    uint64_t blockPositions = 0;
+    uint64_t blockCount = 0;
+    const uint64_t * blockIndex = nullptr;
+    const uint8_t * blocks = nullptr;
+    MappedFile file;
+};
+static std::map<int, std::unique_ptr<MappedTable>> loadedTables;
+static int loadedPieces = 0;
+
+//Blocks are only decompressed when a probe needs them, and kept in a bounded least-recently-used cache.
+//Once a shard is full the least recently used block's buffer is reused, so probing doesn't allocate.
+struct CachedBlock {
+    uint64_t key = 0; //table key and block number
+    std::vector<uint8_t> packed; //the block's values at 2 bits each
+};
+struct CacheShard {
+    std::mutex mutex;
+    std::list<CachedBlock> blocks; //most recently used first
+    std::unordered_map<uint64_t, std::list<CachedBlock>::iterator> lookup;
+    size_t capacity = 0;
+};
+static CacheShard blockCache[CACHE_SHARDS];
+static size_t cacheMegabytes = 16;
+
+static void clearBlockCache(){
+    const size_t blockBytes = TB_BLOCK_POSITIONS / 4;
+    for (auto & shard : blockCache) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.blocks.clear();
+        shard.lookup.clear();
+        shard.capacity = std::max<size_t>(1, cacheMegabytes * 1024 * 1024 / blockBytes / CACHE_SHARDS);
+    }
+}
+void setTablebaseCache(const size_t & megabytes){
+    cacheMegabytes = megabytes;
+    clearBlockCache();
+}
+
+//Unpacks the run-length coded block into 2-bit values
+static void decodeBlock(const MappedTable & table, const uint64_t & block, std::vector<uint8_t> & packed){
+    const uint64_t first = block * table.blockPositions;
+    const uint64_t count = std::min(table.blockPositions, table.positions - first);
+    packed.assign((table.blockPositions + 3) / 4, 0);
+    const uint8_t * data = table.blocks + table.blockIndex[block];
+    const uint8_t * end = table.blocks + table.blockIndex[block + 1];
+    uint64_t position = 0;
+    while (data < end && position < count) {
+        const int value = *data & 3;
+        uint64_t length = (*data >> 2) + 1;
+        data++;
+        if (length == 64) {
+            for (int shift = 0; data < end; shift += 7) {
+                length += uint64_t(*data & 0x7F) << shift;
+                if (!(*data++ & 0x80))
+                    break;
+            }
+        }
+        for (uint64_t i = 0; i < length && position < count; i++, position++)
+            packed[position >> 2] |= uint8_t(value << ((position & 3) * 2));
+    }
+}
+static int cachedValue(const MappedTable & table, const uint64_t & index){
+    const uint64_t block = index / table.blockPositions;
+    const uint64_t key = (uint64_t(table.key) << 40) | block;
+    CacheShard & shard = blockCache[(key * 0x9E3779B97F4A7C15ULL) >> 60];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.lookup.find(key);
+    if (found != shard.lookup.end()) {
+        shard.blocks.splice(shard.blocks.begin(), shard.blocks, found->second);
+    }
+    else {
+        if (shard.blocks.size() >= shard.capacity) { //reuse the least recently used block
+            shard.lookup.erase(shard.blocks.back().key);
+            shard.blocks.splice(shard.blocks.begin(), shard.blocks, std::prev(shard.blocks.end()));
+        }
+        else {
+            shard.blocks.emplace_front();
+        }
+        shard.blocks.front().key = key;
+        decodeBlock(table, block, shard.blocks.front().packed);
+        shard.lookup[key] = shard.blocks.begin();
+    }
+    return packedValue(shard.blocks.front().packed.data(), index % table.blockPositions);
+}
+
+int loadTablebases(const std::string & directory){
+    unloadTablebases();
+    std::error_code error;
+    for (auto & entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() != ".wld")
+            continue;
+        std::unique_ptr<MappedTable> table(new MappedTable);
+        if (!table->file.open(entry.path().string(), true) || table->file.size() < sizeof(TablebaseHeader))
+            continue; //probes jump around, so the file is mapped without read-ahead
+        TablebaseHeader header;
+        std::memcpy(&header, table->file.data(), sizeof(header));
+        TablebaseSlice slice;
+        slice.blackMen = header.blackMen;
+        slice.blackKings = header.blackKings;
+        slice.whiteMen = header.whiteMen;
+        slice.whiteKings = header.whiteKings;
+        const uint64_t indexBytes = (header.blockCount + 1) * sizeof(uint64_t);
+        bool valid = std::memcmp(header.magic, "CKTB", 4) == 0 && header.version == TB_VERSION
+                && header.positions == tablebaseSize(slice) && header.blockPositions > 0
+                && header.blockCount == (header.positions + header.blockPositions - 1) / header.blockPositions
+                && table->file.size() >= sizeof(header) + indexBytes;
+        if (valid) {
+            table->blockIndex = reinterpret_cast<const uint64_t *>(table->file.data() + sizeof(header));
+            table->blocks = table->file.data() + sizeof(header) + indexBytes;
+            valid = (sizeof(header) + indexBytes + table->blockIndex[header.blockCount] <= table->file.size());
+        }
+        if (!valid) {
+            std::cout << "Ignoring damaged or out of date tablebase file " << entry.path().string() << std::endl;
+            continue;
+        }
+        table->key = sliceKey(slice);
+        table->positions = header.positions;
+        table->blockPositions = header.blockPositions;
+        table->blockCount = header.blockCount;
+        loadedTables[table->key] = std::move(table);
+        loadedPieces = std::max(loadedPieces, slicePieces(slice));
+    }
+    clearBlockCache();
+    return loadedPieces;
+}
+void unloadTablebases(){
+    loadedTables.clear();
+    loadedPieces = 0;
+    clearBlockCache();
+}
+int tablebasePieces(){
+    return loadedPieces;
+}
+
+int probeTablebase(const Position & position, const int & side){
+    if (loadedPieces == 0)
+        return TBUnknown;
+    const uint32_t own = (side == Black) ? position.black : position.white;
+    const uint32_t enemy = (side == Black) ? position.white : position.black;
+    if (own == 0)
+        return TBLoss;
+    if (enemy == 0)
+        return TBWin;
+    if (bitCount(own | enemy) > loadedPieces)
+        return TBUnknown;
+
+    TablebaseSlice slice;
+    uint64_t index = 0;
+    if (!tablebaseIndex((side == Black) ? position : flipPosition(position), slice, index))
+        return TBUnknown;
+    auto table = loadedTables.find(sliceKey(slice));
+    if (table == loadedTables.end())
+        return TBUnknown;
+    return cachedValue(*table->second, index);
+}
+
+//Solved tables kept in memory while the generator runs, one byte per index
+static std::map<int, std::vector<uint8_t>> solvedTables;
+
+//Value of a position with Black to move, from a finished table or from the pair being solved
+static int solvedValue(const Position & position,
+                       const int & currentKey,
+                       std::atomic<uint8_t> * current,
+                       const int & partnerKey,
+                       std::atomic<uint8_t> * partner){
+    if (position.black == 0)
+        return TBLoss;
+    if (position.white == 0)
+        return TBWin;
+    TablebaseSlice slice;
+    uint64_t index = 0;
+    tablebaseIndex(position, slice, index);
+    const int key = sliceKey(slice);
+    if (key == currentKey)
+        return current[index].load(std::memory_order_relaxed);
+    if (key == partnerKey)
+        return partner[index].load(std::memory_order_relaxed);
+    return solvedTables.at(key).at(index);
+}
+
+//One pass over a table: a position is a win if a move leads to a loss for the opponent, and a loss if every
+//move leads to a win for the opponent or there are no moves. Returns true if anything was settled.
+static bool solvePass(const TablebaseSlice & slice,
+                      std::atomic<uint8_t> * values,
+                      const int & partnerKey,
+                      std::atomic<uint8_t> * partner,
+                      const int & threadCount){
+    const uint64_t size = tablebaseSize(slice);
+    const int key = sliceKey(slice);
+    std::atomic<bool> changed{false};
+
+    auto worker = [&](const uint64_t & begin, const uint64_t & end){
+        MoveList moveList;
+        for (uint64_t index = begin; index < end; index++) {
+            if (values[index].load(std::memory_order_relaxed) != TBUnknown)
+                continue;
+            Position position;
+            tablebasePosition(slice, index, position);
+            generateMoves(position, Black, moveList);
+
+            bool allWin = true;
+            int value = TBUnknown;
+            for (int i = 0; i < moveList.size; i++) {
+                Position child = position;
+                playMove(child, moveList[i]);
+                int childValue = solvedValue(flipPosition(child), key, values, partnerKey, partner);
+                if (childValue == TBLoss) {
+                    value = TBWin;
+                    break;
+                }
+                if (childValue != TBWin)
+                    allWin = false;
+            }
+            if (value == TBUnknown && allWin)
+                value = TBLoss; //also covers having no moves
+            if (value != TBUnknown) {
+                values[index].store(uint8_t(value), std::memory_order_relaxed);
+                changed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    const uint64_t chunk = (size + threadCount - 1) / threadCount;
+    for (int i = 1; i < threadCount; i++)
+        helpers.emplace_back(worker, std::min(size, i * chunk), std::min(size, (i + 1) * chunk));
+    worker(0, std::min(size, chunk));
+    for (auto & helper : helpers)
+        helper.join();
+    return changed.load();
+}
+
+//Appends one run to a block
+static void writeRun(std::vector<uint8_t> & data, const int & value, const uint64_t & length){
+    if (length < 64) {
+        data.push_back(uint8_t(value | ((length - 1) << 2)));
+        return;
+    }
+    data.push_back(uint8_t(value | (63 << 2)));
+    for (uint64_t rest = length - 64; ; rest >>= 7) {
+        data.push_back(uint8_t((rest & 0x7F) | ((rest >= 0x80) ? 0x80 : 0)));
+        if (rest < 0x80)
+            break;
+    }
+}
+//Returns the size of the file written, 0 if it couldn't be written
+static uint64_t writeTable(const std::string & path, const TablebaseSlice & slice, const std::vector<uint8_t> & values){
+    TablebaseHeader header;
+    std::memcpy(header.magic, "CKTB", 4);
+    header.version = TB_VERSION;
+    header.blackMen = uint8_t(slice.blackMen);
+    header.blackKings = uint8_t(slice.blackKings);
+    header.whiteMen = uint8_t(slice.whiteMen);
+    header.whiteKings = uint8_t(slice.whiteKings);
+    header.blockPositions = TB_BLOCK_POSITIONS;
+    header.positions = values.size();
+    header.blockCount = (values.size() + TB_BLOCK_POSITIONS - 1) / TB_BLOCK_POSITIONS;
+
+    std::vector<uint64_t> blockIndex;
+    std::vector<uint8_t> blocks;
+    for (uint64_t first = 0; first < values.size(); first += TB_BLOCK_POSITIONS) {
+        blockIndex.push_back(blocks.size());
+        const uint64_t end = std::min<uint64_t>(values.size(), first + TB_BLOCK_POSITIONS);
+        for (uint64_t runStart = first; runStart < end; ) {
+            uint64_t runEnd = runStart + 1;
+            while (runEnd < end && values[runEnd] == values[runStart])
+                runEnd++;
+            writeRun(blocks, values[runStart], runEnd - runStart);
+            runStart = runEnd;
+        }
+    }
+    blockIndex.push_back(blocks.size());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(blockIndex.data()), blockIndex.size() * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char *>(blocks.data()), blocks.size());
+    return file ? sizeof(header) + blockIndex.size() * sizeof(uint64_t) + blocks.size() : 0;
+}
+
+bool generateTablebases(const std::string & directory,
+                        const int & maxPieces,
+                        const int & threads,
+                        const std::function<void(const TablebaseSlice &, const TablebaseCounts &, const int &)> & onSlice){
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    const int threadCount = std::max(1, threads);
+    const int pieceLimit = std::min(maxPieces, TB_MAX_PIECES);
+    solvedTables.clear();
+
+    //A table depends on its colour-swapped partner (the opponent's replies), on tables with fewer pieces (captures)
+    //and on tables with fewer men (promotions). Solving by piece count, then men, covers all of them.
+    for (int pieces = 2; pieces <= pieceLimit; pieces++) {
+        for (int men = 0; men <= pieces; men++) {
+            for (int blackMen = 0; blackMen <= men; blackMen++) {
+                for (int blackKings = 0; blackKings <= pieces - men; blackKings++) {
+                    TablebaseSlice slice;
+                    slice.blackMen = blackMen;
+                    slice.blackKings = blackKings;
+                    slice.whiteMen = men - blackMen;
+                    slice.whiteKings = pieces - men - blackKings;
+                    TablebaseSlice partner;
+                    partner.blackMen = slice.whiteMen;
+                    partner.blackKings = slice.whiteKings;
+                    partner.whiteMen = slice.blackMen;
+                    partner.whiteKings = slice.blackKings;
+                    if (slice.blackMen + slice.blackKings == 0 || partner.blackMen + partner.blackKings == 0)
+                        continue; //a side with no pieces has already lost
+                    if (sliceKey(partner) < sliceKey(slice))
+                        continue; //solved together with its partner
+                    if (solvedTables.count(sliceKey(slice)) && solvedTables.count(sliceKey(partner)))
+                        continue;
+
+                    auto start = std::chrono::steady_clock::now();
+                    const bool symmetric = (sliceKey(partner) == sliceKey(slice));
+                    const uint64_t size = tablebaseSize(slice);
+                    const uint64_t partnerSize = tablebaseSize(partner);
+                    std::unique_ptr<std::atomic<uint8_t>[]> values(new std::atomic<uint8_t>[size]);
+                    std::unique_ptr<std::atomic<uint8_t>[]> partnerValues(new std::atomic<uint8_t>[symmetric ? 0 : partnerSize]);
+                    for (uint64_t i = 0; i < size; i++)
+                        values[i].store(TBUnknown, std::memory_order_relaxed);
+                    for (uint64_t i = 0; !symmetric && i < partnerSize; i++)
+                        partnerValues[i].store(TBUnknown, std::memory_order_relaxed);
+
+                    //unused indices are marked as draws up front, so they are never searched
+                    Position unused;
+                    for (uint64_t i = 0; i < size; i++) {
+                        if (!tablebasePosition(slice, i, unused))
+                            values[i].store(TBDraw, std::memory_order_relaxed);
+                    }
+                    for (uint64_t i = 0; !symmetric && i < partnerSize; i++) {
+                        if (!tablebasePosition(partner, i, unused))
+                            partnerValues[i].store(TBDraw, std::memory_order_relaxed);
+                    }
+
+                    std::atomic<uint8_t> * partnerTable = symmetric ? values.get() : partnerValues.get();
+                    bool changed = true;
+                    while (changed) { //until neither table settles anything new
+                        changed = solvePass(slice, values.get(), sliceKey(partner), partnerTable, threadCount);
+                        if (!symmetric)
+                            changed = solvePass(partner, partnerValues.get(), sliceKey(slice), values.get(), threadCount) || changed;
+                    }
+                    const int ms = int(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+                    //whatever is left can't be forced either way
+                    for (int side = 0; side < (symmetric ? 1 : 2); side++) {
+                        const TablebaseSlice & solved = (side == 0) ? slice : partner;
+                        std::atomic<uint8_t> * table = (side == 0) ? values.get() : partnerValues.get();
+                        std::vector<uint8_t> & result = solvedTables[sliceKey(solved)];
+                        result.resize(tablebaseSize(solved));
+                        TablebaseCounts counts;
+                        for (uint64_t i = 0; i < result.size(); i++) {
+                            int value = table[i].load(std::memory_order_relaxed);
+                            result[i] = uint8_t((value == TBUnknown) ? TBDraw : value);
+                            if (value == TBWin)
+                                counts.wins++;
+                            else if (value == TBLoss)
+                                counts.losses++;
+                            else if (tablebasePosition(solved, i, unused))
+                                counts.draws++;
+                            else if (i > 0)
+                                result[i] = result[i - 1]; //never probed, so whatever keeps the run going
+                        }
+                        counts.bytes = writeTable((std::filesystem::path(directory) / tablebaseFileName(solved)).string(), solved, result);
+                        if (counts.bytes == 0)
+                            return false;
+                        if (onSlice)
+                            onSlice(solved, counts, ms);
+                    }
+                }
+            }
+        }
+    }
+    solvedTables.clear();
+    return true;
+}
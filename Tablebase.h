@@ -0,0 +1,65 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <functional>
+#include <string>
+
+#include "Game.h"
+
+static const int TB_MAX_PIECES = 8; //most pieces the indexing is set up for
+
+typedef enum TB_Value{
+    TBUnknown = 0, //the position is not in a loaded table
+    TBDraw,
+    TBWin,  //the side to move wins
+    TBLoss  //the side to move loses
+}TB_Value;
+
+//The material of one table. Tables only hold positions with Black to move; a position with White to move is
+//looked up with the board turned round and the colours swapped.
+struct TablebaseSlice {
+    int blackMen = 0;
+    int blackKings = 0;
+    int whiteMen = 0;
+    int whiteKings = 0;
+};
+
+//Win/loss/draw counts of a generated table
+struct TablebaseCounts {
+    uint64_t wins = 0;
+    uint64_t losses = 0;
+    uint64_t draws = 0;
+    uint64_t bytes = 0; //size of the compressed file
+};
+
+//Perfect-hash index of a position with Black to move. Each group of pieces is ranked in colex order:
+//black men over the 28 squares they can stand on, white men over theirs, then the black kings over the
+//squares the men leave free and the white kings over the squares left after that. Indices where a black and
+//a white man would share a square are not used.
+uint64_t tablebaseSize(const TablebaseSlice & slice);
+bool tablebaseIndex(const Position & position, TablebaseSlice & slice, uint64_t & index); //false if it can't be indexed
+bool tablebasePosition(const TablebaseSlice & slice, const uint64_t & index, Position & position); //false for an unused index
+std::string tablebaseFileName(const TablebaseSlice & slice);
+
+//Solves every table with up to maxPieces pieces and writes them to the directory, one file per table.
+//Tables are solved smallest first, so every capture or promotion leads into a table that is already done.
+bool generateTablebases(const std::string & directory,
+                        const int & maxPieces,
+                        const int & threads,
+                        const std::function<void(const TablebaseSlice &, const TablebaseCounts &, const int &)> & onSlice = nullptr);
+
+//Maps every table file in the directory, read only and shared between processes. Blocks are decompressed
+//as probes need them into a cache of bounded size. Returns the most pieces a loaded table has, 0 if none were found.
+//Loading, unloading and resizing the cache must not happen while anything is probing.
+int loadTablebases(const std::string & directory);
+void unloadTablebases();
+int tablebasePieces(); //0 while nothing is loaded
+void setTablebaseCache(const size_t & megabytes); //memory for decompressed blocks, 16 MB by default
+
+//Result for the side to move, TBUnknown if the position isn't covered
+int probeTablebase(const Position & position, const int & side);
+
+#endif // TABLEBASE_H
@@ -0,0 +1,109 @@
+#include "TranspositionTable.h"
+
+//Layout of the 64-bit data word
+//  bits  0-15 score     bits 16-23 depth    bits 24-25 bound    bits 26-31 age
+//  bits 32-36 from      bits 37-41 to       bits 42-49 move index (0xFF for none)
+static uint64_t packEntry(const int & score, const int & depth, const int & bound, const int & age,
+                          const int & from, const int & to, const int & moveIndex){
+    return uint64_t(uint16_t(int16_t(score)))
+            | (uint64_t(uint8_t(depth)) << 16)
+            | (uint64_t(bound & 0x3) << 24)
+            | (uint64_t(age & 0x3F) << 26)
+            | (uint64_t(from & 0x1F) << 32)
+            | (uint64_t(to & 0x1F) << 37)
+            | (uint64_t(moveIndex & 0xFF) << 42);
+}
+static int entryDepth(const uint64_t & data){
+    return int(uint8_t(data >> 16));
+}
+static int entryBound(const uint64_t & data){
+    return int((data >> 24) & 0x3);
+}
+static int entryAge(const uint64_t & data){
+    return int((data >> 26) & 0x3F);
+}
+
+TranspositionTable::TranspositionTable(const size_t & megabytes, const int & policy){
+    this->policy = policy;
+    resize(megabytes);
+}
+void TranspositionTable::resize(const size_t & megabytes){
+    size_t count = 1;
+    while ((count * 2) * sizeof(Bucket) <= megabytes * 1024 * 1024)
+        count *= 2; //power of two, so a bucket is found with a mask
+    buckets.reset(new Bucket[count]);
+    bucketCount = count;
+    clear();
+}
+void TranspositionTable::clear(){
+    for (size_t i = 0; i < bucketCount; i++) {
+        for (auto & slot : buckets[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    age = 0;
+}
+void TranspositionTable::newSearch(){
+    age = (age + 1) & 0x3F;
+}
+void TranspositionTable::setPolicy(const int & policy){
+    this->policy = policy;
+}
+size_t TranspositionTable::size() const{
+    return bucketCount * SLOTS_PER_BUCKET;
+}
+
+bool TranspositionTable::probe(const uint64_t & key, TTEntry & entry) const{
+    const Bucket & bucket = buckets[key & (bucketCount - 1)];
+    for (auto & slot : bucket.slots) {
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || entryBound(data) == BoundNone)
+            continue;
+
+        entry.score = int(int16_t(uint16_t(data)));
+        entry.depth = entryDepth(data);
+        entry.bound = entryBound(data);
+        const int moveIndex = int((data >> 42) & 0xFF);
+        entry.moveIndex = (moveIndex == 0xFF) ? -1 : moveIndex;
+        entry.from = (moveIndex == 0xFF) ? -1 : int((data >> 32) & 0x1F);
+        entry.to = (moveIndex == 0xFF) ? -1 : int((data >> 37) & 0x1F);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(const uint64_t & key, const int & depth, const int & bound, const int & score,
+                               const Move & move, const int & moveIndex){
+    Bucket & bucket = buckets[key & (bucketCount - 1)];
+
+    //Pick the slot to overwrite: the same position if it is there, otherwise the least useful entry
+    Slot * victim = nullptr;
+    int victimValue = 0;
+    for (auto & slot : bucket.slots) {
+        const uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key) {
+            victim = &slot;
+            break;
+        }
+        //empty and stale slots go first, then the shallowest
+        int value = (entryBound(data) == BoundNone) ? -1000 : entryDepth(data) - ((entryAge(data) != age) ? 256 : 0);
+        if (victim == nullptr || value < victimValue) {
+            victim = &slot;
+            victimValue = value;
+        }
+    }
+
+    const uint64_t old = victim->data.load(std::memory_order_relaxed);
+    const bool sameKey = (victim->check.load(std::memory_order_relaxed) ^ old) == key;
+    if (policy == DepthPreferred && entryBound(old) != BoundNone && entryAge(old) == age
+            && entryDepth(old) > depth && (!sameKey || bound != BoundExact))
+        return; //the entry already there came from a deeper search
+
+    const int index = (moveIndex < 0) ? 0xFF : moveIndex;
+    const uint64_t data = packEntry(score, depth, bound, age, move.from, move.to, index);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
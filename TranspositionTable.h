@@ -0,0 +1,69 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+
+#include "Game.h"
+
+typedef enum Bound_Type{
+    BoundNone = 0,
+    BoundExact,
+    BoundUpper, //the score is at most this (no move reached alpha)
+    BoundLower  //the score is at least this (a move reached beta)
+}Bound_Type;
+
+typedef enum Replacement_Policy{
+    DepthPreferred = 0, //keep the deeper entry when a bucket is full
+    AlwaysReplace       //the newest entry always goes in
+}Replacement_Policy;
+
+//What a probe returns
+struct TTEntry {
+    int score = 0;
+    int depth = 0;
+    int bound = BoundNone;
+    int from = -1; //best move, -1 if there is none
+    int to = -1;
+    int moveIndex = -1; //index of the best move in the generateMoves list of the position
+};
+
+//Fixed-size hash table of searched positions, shared by every search thread.
+//Each slot stores the key XORed with the data, so a slot torn by two threads writing at once no longer
+//verifies against either key and is treated as a miss. No locks are needed for probe or store.
+class TranspositionTable
+{
+public:
+    explicit TranspositionTable(const size_t & megabytes = 32, const int & policy = DepthPreferred);
+
+    void resize(const size_t & megabytes);
+    void clear();
+    void newSearch(); //entries from earlier searches are replaced first
+    void setPolicy(const int & policy);
+
+    bool probe(const uint64_t & key, TTEntry & entry) const;
+    void store(const uint64_t & key, const int & depth, const int & bound, const int & score,
+               const Move & move, const int & moveIndex);
+
+    size_t size() const; //number of entries
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check; //key ^ data
+        std::atomic<uint64_t> data;
+    };
+    static const int SLOTS_PER_BUCKET = 4;
+    struct alignas(64) Bucket { //one cache line
+        Slot slots[SLOTS_PER_BUCKET];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount = 0;
+    int policy = DepthPreferred;
+    uint8_t age = 0;
+};
+
+#endif // TRANSPOSITIONTABLE_H
@@ -0,0 +1,143 @@
+#include "Game.h"
+#include "BackTracking.h"
+#include "Evaluate.h"
+
+#include <chrono>
+#include <thread>
+
+//Fixed positions the benchmarks run on: the opening and a few middle games
+static const std::vector<std::string> benchPositions = {
+    "W:W21-32:B1-12",
+    "W:W17,21,22,23,25,26,27,28,29,30,31,32:B1,2,3,4,5,6,7,9,10,11,12,14",
+    "B:W18,20,21,22,23,25,26,27,29,30,31:B1,2,3,5,6,7,9,10,11,13,16",
+    "W:W19,20,22,23,24,26,27,28,30,31:B2,3,5,6,8,9,10,11,14,15",
+    "B:W18,19,22,23,25,26,K30,31:B1,3,6,9,10,11,K21,27",
+};
+
+//Searches every bench position to a fixed depth with 1, 2, 4 ... threads and reports the speedup over one thread
+static int smpBench(const int & depth, const int & maxThreads, const size_t & hashMb){
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    std::cout << "Lazy SMP scaling, depth " << depth << ", " << benchPositions.size() << " positions" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "time ms" << std::setw(14) << "nodes"
+              << std::setw(14) << "nodes/s" << std::setw(10) << "speedup" << std::setw(12) << "nps scale"
+              << std::setw(12) << "1st cut %" << std::endl;
+
+    double baseTime = 0;
+    double baseNps = 0;
+    TranspositionTable table(hashMb);
+    for (int threads : threadCounts) {
+        SearchLimits limits;
+        limits.maxDepth = depth;
+        limits.timeMs = 0;
+        limits.threads = threads;
+
+        uint64_t nodes = 0;
+        SearchStats stats; //for the first move cutoff rate, which shows how good the move ordering is
+        double seconds = 0;
+        for (auto & fen : benchPositions) {
+            Position position;
+            int side = White;
+            readFen(fen, position, side);
+            table.clear(); //every run starts from the same empty table
+
+            auto start = std::chrono::steady_clock::now();
+            SearchResult result = searchPosition(position, side, limits, &table);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            nodes += result.nodes;
+            stats.add(result.stats);
+        }
+        double nps = nodes / std::max(seconds, 1e-9);
+        if (threads == 1) {
+            baseTime = seconds;
+            baseNps = nps;
+        }
+        std::cout << std::setw(8) << threads << std::setw(12) << int(seconds * 1000) << std::setw(14) << nodes
+                  << std::setw(14) << uint64_t(nps) << std::setw(10) << std::fixed << std::setprecision(2) << baseTime / seconds
+                  << std::setw(12) << nps / baseNps << std::setw(12) << std::setprecision(1) << 100.0 * stats.firstMoveCutoffRate() << std::endl;
+    }
+    return 0;
+}
+
+//Evaluates every position of a set of random games over and over and reports evaluations per second
+static int evalBench(const int & seconds){
+    std::vector<std::pair<Position, int>> positions;
+    srand(1);
+    while (positions.size() < 10000) {
+        Position position;
+        boardReset(position);
+        int side = White;
+        for (int ply = 0; ply < 200; ply++) {
+            MoveList moveList;
+            generateMoves(position, side, moveList);
+            if (moveList.size == 0)
+                break;
+            positions.push_back({ position, side });
+            playMove(position, moveList[rand() % moveList.size]);
+            side = (side == White) ? Black : White;
+        }
+    }
+
+    std::cout << "Evaluation speed, " << positions.size() << " positions from random games" << std::endl;
+    uint64_t evaluations = 0;
+    int64_t checksum = 0; //keeps the calls from being optimised away
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds) {
+        for (auto & entry : positions)
+            checksum += evaluate(entry.first, entry.second);
+        evaluations += positions.size();
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::cout << std::setw(14) << "evaluations" << std::setw(12) << "time ms" << std::setw(14) << "evals/s" << std::setw(14) << "ns/eval" << std::endl;
+    std::cout << std::setw(14) << evaluations << std::setw(12) << int(elapsed * 1000) << std::setw(14) << uint64_t(evaluations / elapsed)
+              << std::setw(14) << std::fixed << std::setprecision(1) << 1e9 * elapsed / evaluations << std::endl;
+    std::cout << "checksum " << checksum << std::endl;
+    return 0;
+}
+
+static void printUsage(){
+    std::cout << "Usage: checkers_bench <benchmark> [options]" << std::endl
+              << "  smp [--depth N] [--threads N] [--hash MB]" << std::endl
+              << "      time-to-depth speedup and nodes/sec scaling from 1 to N search threads" << std::endl
+              << "  eval [--seconds N]" << std::endl
+              << "      evaluations per second of the static evaluation" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+    std::string benchmark = argv[1];
+    int depth = 14;
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    size_t hashMb = 64;
+    int seconds = 3;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc)
+            depth = std::atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--hash" && i + 1 < argc)
+            hashMb = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seconds" && i + 1 < argc)
+            seconds = std::max(1, std::atoi(argv[++i]));
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (benchmark == "smp")
+        return smpBench(depth, threads, hashMb);
+    if (benchmark == "eval")
+        return evalBench(seconds);
+    printUsage();
+    return 2;
+}
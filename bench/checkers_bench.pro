@@ -0,0 +1,15 @@
+#Headless engine benchmarks, built by ../Checkers.pro after the core library
+#Run checkers_bench with no arguments for the list of benchmarks.
+
+CONFIG -= qt
+
+TARGET = checkers_bench
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+
+CORE_BUILD_DIR = $$OUT_PWD/../core
+include(../core/checkers_core.pri)
+
+SOURCES += \
+        bench.cpp
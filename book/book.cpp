@@ -0,0 +1,150 @@
+#include "Game.h"
+#include "BackTracking.h"
+#include "OpeningBook.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <thread>
+
+static void printUsage(){
+    std::cout << "Usage: checkers_book [options]" << std::endl
+              << "  --pdn FILE        add the games of a PDN file (may be given more than once)" << std::endl
+              << "  --selfplay N      add N games the engine plays against itself (default 0)" << std::endl
+              << "  --depth N         search depth of each self-play move (default 6)" << std::endl
+              << "  --random N        plies of each self-play game picked at random, so games differ (default 4)" << std::endl
+              << "  --max-moves N     self-play games still going after N plies are draws (default 200)" << std::endl
+              << "  --plies N         moves of each game that go into the book (default 16)" << std::endl
+              << "  --min-games N     leave out moves played in fewer than N games (default 2)" << std::endl
+              << "  --threads N       self-play games played at once (default: all cores)" << std::endl
+              << "  --seed N          seed for the random plies (default 1)" << std::endl
+              << "  --out FILE        book file to write (default book.bin)" << std::endl;
+}
+
+//Plays one game from the start position and returns WhiteWin, BlackWin or Draw
+static int selfPlayGame(std::mt19937 & random, const SearchLimits & limits, const int & randomPlies,
+                        const int & maxMoves, TranspositionTable & table, std::vector<Move> & moves){
+    Position position;
+    boardReset(position);
+    int side = White;
+    moves.clear();
+    table.clear();
+    for (int ply = 0; ply < maxMoves; ply++) {
+        int state = win(position, side);
+        if (state != ValidMove)
+            return state;
+        Move move;
+        if (ply < randomPlies) {
+            MoveList moveList;
+            generateMoves(position, side, moveList);
+            move = moveList[std::uniform_int_distribution<int>(0, moveList.size - 1)(random)];
+        }
+        else {
+            move = searchPosition(position, side, limits, &table).bestMove;
+        }
+        moves.push_back(move);
+        playMove(position, move);
+        side = (side == White) ? Black : White;
+    }
+    return Draw;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> pdnFiles;
+    int selfPlayGames = 0;
+    int depth = 6;
+    int randomPlies = 4;
+    int maxMoves = 200;
+    int plies = 16;
+    int minGames = 2;
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    unsigned int seed = 1;
+    std::string output = "book.bin";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--pdn" && i + 1 < argc)
+            pdnFiles.push_back(argv[++i]);
+        else if (arg == "--selfplay" && i + 1 < argc)
+            selfPlayGames = std::atoi(argv[++i]);
+        else if (arg == "--depth" && i + 1 < argc)
+            depth = std::atoi(argv[++i]);
+        else if (arg == "--random" && i + 1 < argc)
+            randomPlies = std::atoi(argv[++i]);
+        else if (arg == "--max-moves" && i + 1 < argc)
+            maxMoves = std::atoi(argv[++i]);
+        else if (arg == "--plies" && i + 1 < argc)
+            plies = std::atoi(argv[++i]);
+        else if (arg == "--min-games" && i + 1 < argc)
+            minGames = std::atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = unsigned(std::atoi(argv[++i]));
+        else if (arg == "--out" && i + 1 < argc)
+            output = argv[++i];
+        else {
+            printUsage();
+            return (arg == "--help") ? 0 : 2;
+        }
+    }
+    if (pdnFiles.empty() && selfPlayGames <= 0) {
+        printUsage();
+        return 2;
+    }
+
+    OpeningBookBuilder builder;
+    for (auto & path : pdnFiles) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cout << "Could not open " << path << std::endl;
+            return 1;
+        }
+        std::cout << "Added " << importPdn(file, builder, plies) << " games from " << path << std::endl;
+    }
+
+    if (selfPlayGames > 0) {
+        std::cout << "Playing " << selfPlayGames << " self-play games at depth " << depth << " on " << threads << " threads" << std::endl;
+        SearchLimits limits;
+        limits.maxDepth = depth;
+        limits.timeMs = 0;
+        limits.threads = 1; //the games run side by side instead
+
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<int> nextGame{0};
+        std::atomic<int> results[5] = {};
+        std::vector<OpeningBookBuilder> builders(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t](){
+                std::mt19937 random(seed + t);
+                TranspositionTable table(16);
+                std::vector<Move> moves;
+                Position startPosition;
+                boardReset(startPosition);
+                for (int game = nextGame++; game < selfPlayGames; game = nextGame++) {
+                    random.seed(seed * 7919 + game); //the same games whatever the thread count
+                    int result = selfPlayGame(random, limits, randomPlies, maxMoves, table, moves);
+                    builders.at(t).addGame(startPosition, White, moves, result, plies);
+                    results[result]++;
+                }
+            });
+        }
+        for (auto & worker : workers)
+            worker.join();
+        for (auto & threadBuilder : builders)
+            builder.merge(threadBuilder);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "White won " << results[WhiteWin] << ", Black won " << results[BlackWin] << ", drawn " << results[Draw]
+                  << " in " << std::fixed << std::setprecision(1) << seconds << " s" << std::endl;
+    }
+
+    int64_t written = builder.write(output, uint32_t(std::max(1, minGames)));
+    if (written < 0) {
+        std::cout << "Could not write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << written << " of " << builder.entries() << " book moves to " << output << std::endl;
+    return 0;
+}
@@ -0,0 +1,15 @@
+#Opening book builder, built by ../Checkers.pro after the core library
+#Run with --help for options. The GUI plays from the book with --book <file>.
+
+CONFIG -= qt
+
+TARGET = checkers_book
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+
+CORE_BUILD_DIR = $$OUT_PWD/../core
+include(../core/checkers_core.pri)
+
+SOURCES += \
+        book.cpp
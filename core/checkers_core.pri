@@ -0,0 +1,9 @@
+#Links libcheckers_core. Set CORE_BUILD_DIR to the directory checkers_core.pro was built in before including this.
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+LIBS += -L$$CORE_BUILD_DIR -lcheckers_core
+
+win32-msvc*: PRE_TARGETDEPS += $$CORE_BUILD_DIR/checkers_core.lib
+else: PRE_TARGETDEPS += $$CORE_BUILD_DIR/libcheckers_core.a
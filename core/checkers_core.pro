@@ -0,0 +1,33 @@
+#Rules and AI as a static library with no Qt dependency: qmake checkers_core.pro && make
+#Builds libcheckers_core.a (checkers_core.lib with MSVC), which the GUI and the headless tools link.
+
+TEMPLATE = lib
+TARGET = checkers_core
+CONFIG += staticlib c++17 thread
+CONFIG -= qt
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../BackTracking.cpp \
+    ../Bitboard.cpp \
+    ../Evaluate.cpp \
+    ../Game.cpp \
+    ../MappedFile.cpp \
+    ../OpeningBook.cpp \
+    ../SearchStats.cpp \
+    ../SearchTrace.cpp \
+    ../Tablebase.cpp \
+    ../TranspositionTable.cpp
+
+HEADERS += \
+    ../BackTracking.h \
+    ../Bitboard.h \
+    ../Evaluate.h \
+    ../Game.h \
+    ../MappedFile.h \
+    ../OpeningBook.h \
+    ../SearchStats.h \
+    ../SearchTrace.h \
+    ../Tablebase.h \
+    ../TranspositionTable.h
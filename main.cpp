@@ -1,8 +1,10 @@
-#include <QTimer>
 #include <QPushButton>
 #include <QComboBox>
 #include <QMessageBox>
 #include <QCheckBox>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <QtConcurrent>
 
 #include "main.h"
 #include "Game.h"
@@ -10,7 +12,13 @@
 #include "Square.h"
 #include "Check.h"
 #include "BackTracking.h"
+#include "SearchTrace.h"
+#include "OpeningBook.h"
+#include "Tablebase.h"
 #include <map>
+#include <memory>
+#include <atomic>
+#include <fstream>
 
 namespace CV{
     std::map<std::pair<char, char>, char> gameBoard;
@@ -22,65 +30,109 @@ namespace CV{
 
     QString movesListString = QString("White\tBlack\n"); //keeps a list of the moves taken
     QString movesListString2 = QString("White\tBlack\n"); //for the second column if the first fills up
+
+    UndoStack undoStack; //moves played this game, taken back by the undo button
+    std::vector<std::pair<int, int>> movesListLengths; //lengths of the two move list strings before each move on undoStack
+
+    int gameNumber = 0; //changes on every reset and undo, so an AI move searched for an earlier position is thrown away
+    int aiGameNumber = 0; //game the running AI search belongs to
+    QString thinkingString = QString(""); //AI search progress
+
+    //Scene items created once by drawSceneBoard and updated in place
+    QGraphicsTextItem * playerTurnText = nullptr;
+    QGraphicsTextItem * displayBar = nullptr;
+    QGraphicsTextItem * movesList = nullptr;
+    QGraphicsTextItem * movesList2 = nullptr;
+    QGraphicsTextItem * thinkingText = nullptr; //shows thinkingString
+    QGraphicsTextItem * statsPanel = nullptr; //statistics of the AI's last search
+
+    std::string statsFile = ""; //each AI search's statistics are added to this file as a line of JSON
+
+    std::map<std::pair<char, char>, GamePiece *> pieceItems; //the piece drawn on each square
+    std::vector<GamePiece *> removedPieces; //off the scene, deleted on the next update
+
+    GameController * gameController = nullptr;
 }
 namespace CF{
-    bool resetFlag = false; //Reset the game
     bool refreshFlag = false; //Refresh the scene
 
     bool whiteAIFlag = false; //Is white AI-controlled?
-    bool blackAIFlag = false; //Is black AI-controlled?
-    bool playerMovingFlag = false; //Avoids interrupting
+    bool blackAIFlag = true; //Is black AI-controlled?
+    bool aiThinkingFlag = false; //The AI is searching on a worker thread
+    bool draggingFlag = false; //A piece is being dragged, QDrag::exec is running its own event loop
+    bool ponderFlag = true; //The AI thinks on the human's time
+
+    std::shared_ptr<std::atomic<bool>> aiStop; //Cancels the running AI search
+    std::shared_ptr<std::atomic<bool>> ponderStop; //Cancels the ponder search
+    std::shared_ptr<std::atomic<bool>> ponderActive; //Cleared on a ponder hit, so the ponder search takes on the AI's limits
 }
 
 void drawSceneBoard( QGraphicsScene & scene){
     int xOffset = 10;
     int yOffset = 85;
 
-
-    QGraphicsTextItem * playerTurnText = scene.addText( (CV::playerTurn == White) ? QString("White to move") : QString("Black to move") );
-    playerTurnText->setFont(QFont("Times New Roman", 16));
-    playerTurnText->setPos(0, 30);
+    //The text items are kept and updated in place by updateSceneText
+    CV::playerTurnText = scene.addText(QString(""));
+    CV::playerTurnText->setFont(QFont("Times New Roman", 16));
+    CV::playerTurnText->setPos(0, 30);
 
     //Displays if the move was valid or if a colour has won
-    QGraphicsTextItem * displayBar = scene.addText(QString(CV::gameStateVector.at(CV::gameStatus).c_str()));
-    displayBar->setFont(QFont("Times New Roman", 22));
-    displayBar->setPos(620+75, 30);
+    CV::displayBar = scene.addText(QString(""));
+    CV::displayBar->setFont(QFont("Times New Roman", 22));
+    CV::displayBar->setPos(620+75, 30);
 
     //Displays the moves that have been made this game
-    QGraphicsTextItem * movesList = scene.addText(CV::movesListString);
-    movesList->setFont(QFont("Times", 12));
-    movesList->setPos(620+75, 150);
+    CV::movesList = scene.addText(QString(""));
+    CV::movesList->setFont(QFont("Times", 12));
+    CV::movesList->setPos(620+75, 150);
     //movesList->setTextWidth(100);
-    movesList->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
+    CV::movesList->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
 
-    if(CV::movesListString.size() >= 694){ //if the text gets too long, off the window, start a new column
-        QGraphicsTextItem * movesList2 = scene.addText(CV::movesListString2);
-        movesList2->setFont(QFont("Times", 12));
-        movesList2->setPos(800+75, 150);
-        movesList2->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
-    }
+    //Second column, shown once the text gets too long for the first
+    CV::movesList2 = scene.addText(QString(""));
+    CV::movesList2->setFont(QFont("Times", 12));
+    CV::movesList2->setPos(800+75, 150);
+    CV::movesList2->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
 
     //reset button
     QPushButton *resetButton = new QPushButton;
-    QObject::connect(resetButton, &QPushButton::clicked, [](){CF::resetFlag = true;});
+    QObject::connect(resetButton, &QPushButton::clicked, [](){
+        CV::gameController->reset();
+    });
     resetButton->setFont(QFont("Times New Roman", 14));
     resetButton->setGeometry(QRect(620 + 75, 75, 120, 30));
     resetButton->setText("Reset Game");
     scene.addWidget(resetButton);
 
+    //undo button
+    QPushButton *undoButton = new QPushButton;
+    QObject::connect(undoButton, &QPushButton::clicked, [](){
+        CV::gameController->undo();
+    });
+    undoButton->setFont(QFont("Times New Roman", 14));
+    undoButton->setGeometry(QRect(620 + 75, 110, 120, 30));
+    undoButton->setText("Undo Move");
+    scene.addWidget(undoButton);
+
+    //Shows the AI's progress while it is thinking
+    CV::thinkingText = scene.addText(QString(""));
+    CV::thinkingText->setFont(QFont("Times", 12));
+    CV::thinkingText->setPos(620+75+130, 75);
+
+    //Side panel with what the AI's last search did
+    CV::statsPanel = scene.addText(QString(""));
+    CV::statsPanel->setFont(QFont("Times", 10));
+    CV::statsPanel->setPos(980+75, 150);
+    CV::statsPanel->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
+
     QGraphicsItem *BackdropItem = new Backdrop(); //can accept drops and return an error if the user misses dropping on a valid square
     scene.addItem(BackdropItem);
 
     //Prints the black squares of the board
-    for (char y = '1'; y <= '8'; y++){
-        for (char x = 'a'; x <= 'h'; x++){
-            if ((((y - 49) % 2) == 0) == (((x - 97) % 2) == 0)){  //XNOR to help with the diagonalness of the board
-                QGraphicsItem *boardSquareItem = new BoardSquare((x-97)*75 + 75, 525-(y-49)*75 + yOffset, std::make_pair(x, y));
-                //visualBoard[std::make_pair(x, y)] = boardSquareItem;
-                scene.addItem(boardSquareItem);
-            //else -> is a white square, so doesn't matter
-            }
-        }
+    for (int square = 0; square < 32; square++){
+        const std::pair<char, char> name = squareName(square);
+        QGraphicsItem *boardSquareItem = new BoardSquare((name.first-97)*75 + 75, 525-(name.second-49)*75 + yOffset, name);
+        scene.addItem(boardSquareItem);
     }
 
     //Border rectangle
@@ -107,71 +159,496 @@ void drawSceneBoard( QGraphicsScene & scene){
         letter->setText(QString(s[0]));
         scene.addItem(letter);
     }
+
+    updateSceneText();
 }
-void drawScenePieces(QGraphicsScene & scene, std::map<std::pair<char, char>, char> & gameBoard){
+//Refreshes the status and move list text items
+void updateSceneText(){
+    CV::playerTurnText->setPlainText( (CV::playerTurn == White) ? QString("White to move") : QString("Black to move") );
+    CV::displayBar->setPlainText(QString(CV::gameStateVector.at(CV::gameStatus).c_str()));
+    CV::movesList->setPlainText(CV::movesListString);
+    CV::movesList2->setPlainText(CV::movesListString2);
+    CV::movesList2->setVisible(CV::movesListString.size() >= 694); //if the text gets too long, off the window, start a new column
+    CV::thinkingText->setPlainText(CV::thinkingString);
+}
+//Colour a piece is drawn in, returns false for an empty square
+static bool pieceStyle(const char & piece, QColor & color, bool & king){
+    king = (piece == pieces[BlackKing] || piece == pieces[WhiteKing]);
+    if (piece == pieces[Black] || piece == pieces[BlackKing]){
+        color = QColor::fromRgb(101,70,50);
+    }else if (piece == pieces[White] || piece == pieces[WhiteKing]){
+        color = QColor::fromRgb(251,228,122);
+    }else{
+        return false;
+    }
+    return true;
+}
+//Scene position of the top left corner of a square
+static QPoint squarePos(const std::pair<char, char> & square){
     int yOffset = 85;
+    return QPoint((square.first-97)*75 + 75, 525 - (square.second-49)*75+yOffset);
+}
+//Takes a piece off the scene. It is deleted later, as it may be the piece the player is still dragging.
+static void removeScenePiece(QGraphicsScene & scene, const std::pair<char, char> & square){
+    auto it = CV::pieceItems.find(square);
+    if (it == CV::pieceItems.end())
+        return;
+    scene.removeItem(it->second);
+    CV::removedPieces.push_back(it->second);
+    CV::pieceItems.erase(it);
+}
+static void addScenePiece(QGraphicsScene & scene, const std::pair<char, char> & square, const char & piece){
     QColor color = Qt::white;
-    for (char y = '1'; y <= '8'; y++) {
-        for (char x = 'a'; x <= 'h'; x++) {
-            if ((((y-49) % 2) == 0) == (((x - 97) % 2) == 0)) { //Helps with the diagonalness of the board
-                char piece = gameBoard[std::make_pair(x,y)];
-                bool king = false;
-                //std::cout<<"Found ["<<piece<<"] at "<<x<<","<<y<<std::endl;
-                if (piece == pieces[Black]){
-                    color = QColor::fromRgb(101,70,50);
-                }else if(piece == pieces[BlackKing]){
-                    color = QColor::fromRgb(101,70,50);
-                    king = true;
-                }else if (piece == pieces[White]){
-                    color = QColor::fromRgb(251,228,122);
-                }else if (piece == pieces[WhiteKing]){
-                    color = QColor::fromRgb(251,228,122);
-                    king = true;
-                }else{
-                    continue;
-                }
-                QGraphicsItem *gamePieceItem = new GamePiece((x-97)*75 + 75, 525 - (y-49)*75+yOffset, color, std::make_pair(x, y), king);
-                scene.addItem(gamePieceItem);
-            }
+    bool king = false;
+    if (!pieceStyle(piece, color, king))
+        return;
+    QPoint pos = squarePos(square);
+    GamePiece *gamePieceItem = new GamePiece(pos.x(), pos.y(), color, square, king);
+    scene.addItem(gamePieceItem);
+    CV::pieceItems[square] = gamePieceItem;
+}
+//Deletes the pieces taken off the scene, unless a drag is running: the dragged piece may be one of them,
+//and its mouseMoveEvent is still on the stack until the drag ends
+static void freeRemovedPieces(){
+    if (CF::draggingFlag)
+        return;
+    for (auto item : CV::removedPieces)
+        delete item;
+    CV::removedPieces.clear();
+}
+bool aiThinking(){
+    return CF::aiThinkingFlag;
+}
+void dragStarted(){
+    CF::draggingFlag = true;
+}
+void dragFinished(){
+    CF::draggingFlag = false;
+    QTimer::singleShot(0, qApp, [](){ freeRemovedPieces(); }); //once the dragged piece's handler has returned
+}
+//Replaces every piece on the scene, used when a game starts
+void drawScenePieces(QGraphicsScene & scene, std::map<std::pair<char, char>, char> & gameBoard){
+    freeRemovedPieces();
+    while (!CV::pieceItems.empty())
+        removeScenePiece(scene, CV::pieceItems.begin()->first);
+
+    for (auto el : gameBoard)
+        addScenePiece(scene, el.first, el.second);
+}
+//Brings the pieces on the scene in line with the board after a move. Only the moved piece,
+//captured pieces and crowned pieces are touched.
+void updateScenePieces(QGraphicsScene & scene,
+                       const std::map<std::pair<char, char>, char> & before,
+                       const std::map<std::pair<char, char>, char> & after,
+                       std::pair<char, char> from,
+                       std::pair<char, char> to){
+    freeRemovedPieces();
+
+    //The moved piece keeps its item
+    auto fromIt = after.find(from);
+    auto toIt = after.find(to);
+    if (fromIt != after.end() && toIt != after.end() && fromIt->second == pieces[Empty] && toIt->second != pieces[Empty]
+            && before.at(from) != pieces[Empty] && before.at(to) == pieces[Empty]) {
+        auto it = CV::pieceItems.find(from);
+        if (it != CV::pieceItems.end()) {
+            GamePiece * item = it->second;
+            CV::pieceItems.erase(it);
+            QPoint pos = squarePos(to);
+            item->moveToSquare(pos.x(), pos.y(), to);
+            CV::pieceItems[to] = item;
+        }
+    }
+
+    for (auto el : after) {
+        auto it = CV::pieceItems.find(el.first);
+        QColor color = Qt::white;
+        bool king = false;
+        if (!pieceStyle(el.second, color, king)) { //captured
+            removeScenePiece(scene, el.first);
+        }
+        else if (it == CV::pieceItems.end()) {
+            addScenePiece(scene, el.first, el.second);
+        }
+        else if (it->second->getColor() != color) {
+            removeScenePiece(scene, el.first);
+            addScenePiece(scene, el.first, el.second);
         }
+        else if (it->second->isKing() != king) { //crowned
+            it->second->setKing(king);
+        }
+    }
+    for (auto el : CV::pieceItems) //the dragged piece was hidden while it was dragged
+        el.second->show();
+}
+//Pushes the move just played from 'position' onto the undo stack. Between two squares the longest capture is the one played.
+static void pushUndo(Position & position, const Move & move){
+    if (CV::undoStack.full()){ //the oldest moves can't be taken back any more
+        CV::undoStack.clear();
+        CV::movesListLengths.clear();
+    }
+    makeMove(position, move, CV::undoStack);
+    CV::movesListLengths.push_back(std::make_pair(CV::movesListString.size(), CV::movesListString2.size()));
+}
+//The legal move between the two squares, as generateMoves lists it. Between two squares the longest capture is the one played.
+static bool findLegalMove(const Position & position, const int & side, const int & from, const int & to, Move & move){
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+    int best = -1;
+    for (int i = 0; i < moveList.size; i++) {
+        if (moveList[i].from == from && moveList[i].to == to && (best < 0 || moveList[i].jumps > moveList[best].jumps))
+            best = i;
     }
+    if (best >= 0)
+        move = moveList[best];
+    return best >= 0;
 }
+//Adds the move to the moves list, after the game status and turn have been updated for it
+static void addMoveText(const std::pair<char, char> & from, const std::pair<char, char> & to){
+    std::stringstream ss {};
+    ss << char(toupper(from.first)) << from.second << " -> " << char(toupper(to.first)) << to.second << " ";
+    if(CV::gameStatus == WhiteWin || CV::gameStatus == BlackWin || CV::gameStatus == Draw)
+        ss<<"#";
+    else if (CV::playerTurn == White) //If the next player's turn is white
+        ss << "\n";
+    else
+        ss <<"| ";
+
+    if(CV::movesListString.size() < 700)
+        CV::movesListString += QString(ss.str().c_str());
+    else
+        CV::movesListString2 += QString(ss.str().c_str());
+}
+//Plays a move from generateMoves on the board, recording it for undo, and updates the turn and the game status
+static void playBoardMove(const Move & move){
+    Position position = toPosition(CV::gameBoard);
+    pushUndo(position, move);
+    fromPosition(position, CV::gameBoard);
+    CV::playerTurn = (CV::playerTurn == White) ? Black : White;
+    CV::gameStatus = win(position, CV::playerTurn);
+    if (CV::gameStatus != ValidMove)
+        std::cout<< CV::gameStateVector.at(CV::gameStatus)<<std::endl;
+    addMoveText(squareName(move.from), squareName(move.to));
+}
+//Plays a human's move. Only moves generateMoves lists are accepted, so the rules, mandatory captures included,
+//are the engine's, and every move played has its undo record.
 void redrawBoard(std::pair<char, char> from, std::pair<char, char> to, QGraphicsScene * scene){
-    CF::playerMovingFlag = true;
     std::cout<<"Move: "<<char(from.first)<<char(from.second)<<"->"<<char(to.first)<<char(to.second)<<std::endl;
-    scene->clear();
-    if(CV::gameStatus != WhiteWin && CV::gameStatus != BlackWin && CV::gameStatus != Draw){ //if the game is running
+    std::map<std::pair<char, char>, char> before = CV::gameBoard;
+    if(!CF::aiThinkingFlag && CV::gameStatus != WhiteWin && CV::gameStatus != BlackWin && CV::gameStatus != Draw){ //if the game is running and the AI isn't mid-move
+        Move move;
+        if(findLegalMove(toPosition(CV::gameBoard), CV::playerTurn, squareIndex(from), squareIndex(to), move)){
+            playBoardMove(move);
+        }
+        else{
+            //checkMove explains what is wrong with the move. It should never accept a move generateMoves doesn't list.
+            if(checkMove(CV::playerTurn, from, to, CV::gameBoard).first)
+                std::cout<<"Programmer error: the move validator accepted a move the move generator doesn't list."<<std::endl;
+            CV::gameStatus = InvalidMove;
+            std::cout<< CV::gameStateVector.at(CV::gameStatus)<<std::endl;
+        }
+    }
+    updateScenePieces(*scene, before, CV::gameBoard, from, to);
+    updateSceneText();
+    if(CV::gameBoard != before)
+        CV::gameController->moveFinished(CV::gameStatus);
+}
+//Plays a move the AI chose from generateMoves as it is, so the capture route it searched is the one taken
+void redrawBoard(const Move & move, QGraphicsScene * scene){
+    const std::pair<char, char> from = squareName(move.from);
+    const std::pair<char, char> to = squareName(move.to);
+    std::cout<<"Move: "<<moveName(move)<<std::endl;
+    std::map<std::pair<char, char>, char> before = CV::gameBoard;
+    if(CV::gameStatus != WhiteWin && CV::gameStatus != BlackWin && CV::gameStatus != Draw)
+        playBoardMove(move);
+    updateScenePieces(*scene, before, CV::gameBoard, from, to);
+    updateSceneText();
+    if(CV::gameBoard != before)
+        CV::gameController->moveFinished(CV::gameStatus);
+}
+//Starts the AI search on a worker thread, so the GUI keeps painting while it thinks.
+//The move comes back to the GUI thread through aiWatcher's finished signal.
+void startAIMove(QFutureWatcher<Move> * aiWatcher){
+    CF::aiThinkingFlag = true;
+    CF::aiStop = std::make_shared<std::atomic<bool>>(false);
+    CV::aiGameNumber = CV::gameNumber;
+    CV::thinkingString = QString("Thinking...");
+    CV::thinkingText->setPlainText(CV::thinkingString);
 
-        CV::gameStatus = changeTurn(CV::gameBoard, std::make_pair(from, to), CV::playerTurn);
+    const int gameNumber = CV::gameNumber;
+    SearchLimits limits = getSearchLimits();
+    limits.stop = CF::aiStop.get();
+    limits.onIteration = [gameNumber](const SearchResult & progress){ //runs on the worker thread
+        QString text = QString("Thinking: depth %1, %2 nodes").arg(progress.depth).arg(progress.nodes);
+        QMetaObject::invokeMethod(qApp, [text, gameNumber](){
+            if(CF::aiThinkingFlag && gameNumber == CV::gameNumber){
+                CV::thinkingString = text;
+                CV::thinkingText->setPlainText(text);
+            }
+        }, Qt::QueuedConnection);
+    };
 
-        if (CV::gameStatus != ValidMove)
-            std::cout<< CV::gameStateVector.at(CV::gameStatus)<<std::endl;
+    Position position = toPosition(CV::gameBoard);
+    int side = CV::playerTurn;
+    std::shared_ptr<std::atomic<bool>> stop = CF::aiStop; //keeps the flag alive for as long as the search runs
+    aiWatcher->setFuture(QtConcurrent::run([position, side, limits, stop](){
+        return chooseMoveAI(position, side, limits);
+    }));
+}
 
-        if(CV::gameStatus != InvalidMove){
-            std::stringstream ss {};
-            ss << char(toupper(from.first)) << from.second << " -> " << char(toupper(to.first)) << to.second << " ";
-            if(CV::gameStatus == WhiteWin || CV::gameStatus == BlackWin || CV::gameStatus == Draw)
-                ss<<"#";
-            else if (CV::playerTurn == White) //If the next player's turn is white
-                ss << "\n";
-            else
-                ss <<"| ";
-
-            if(CV::movesListString.size() < 700)
-                CV::movesListString += QString(ss.str().c_str());
-            else
-                CV::movesListString2 += QString(ss.str().c_str());
-        }
+GameController::GameController(QGraphicsScene * scene, QObject * parent) : QObject(parent), scene(scene){
+    //The AI's move arrives here on the GUI thread once the worker has finished searching
+    connect(&aiWatcher, &QFutureWatcher<Move>::finished, this, [this](){
+        CF::aiThinkingFlag = false;
+        CV::thinkingString = QString("");
+        CV::thinkingText->setPlainText(CV::thinkingString);
+        if(CV::aiGameNumber != CV::gameNumber) //the game was reset while the AI was thinking
+            return;
+        replyKnown = lastPredictedReply(predictedReply);
+        playAIMove(aiWatcher.result(), lastSearchStats());
+    });
+    //The ponder search ends here: stopped after a wrong prediction, done before the human moved, or after a hit
+    connect(&ponderWatcher, &QFutureWatcher<SearchResult>::finished, this, &GameController::ponderFinished);
+    //Queued, so the move that caused it (and the drag that made it) has finished before the AI starts
+    connect(this, &GameController::moveCompleted, this, &GameController::scheduleAI, Qt::QueuedConnection);
+    connect(this, &GameController::gameEnded, this, &GameController::endGame, Qt::QueuedConnection);
+    connect(this, &GameController::gameReset, this, &GameController::scheduleAI, Qt::QueuedConnection);
+}
+void GameController::playAIMove(const Move & move, const SearchStats & stats){
+    CV::statsPanel->setPlainText(QString("AI search\n") + QString(statsText(stats).c_str()));
+    if(!CV::statsFile.empty()){
+        std::ofstream file(CV::statsFile, std::ios::app);
+        file << statsJson(stats) << std::endl;
+    }
+    redrawBoard(move, this->scene);
+}
+//Searches the position after the predicted reply on the human's time, on the warm transposition table
+void GameController::startPondering(){
+    if(!CF::ponderFlag || !replyKnown)
+        return;
+    Position position = toPosition(CV::gameBoard);
+    MoveList moveList;
+    generateMoves(position, CV::playerTurn, moveList);
+    bool legal = false;
+    for(int i = 0; i < moveList.size; i++)
+        legal = legal || (moveList[i].from == predictedReply.from && moveList[i].to == predictedReply.to
+                          && moveList[i].captured == predictedReply.captured);
+    if(!legal)
+        return;
+    playMove(position, predictedReply);
+    const int side = (CV::playerTurn == White) ? Black : White;
+    if(win(position, side) != ValidMove)
+        return;
+
+    ponderPosition = position;
+    ponderSide = side;
+    ponderState = PonderRunning;
+    ponderGameNumber = CV::gameNumber;
+    CF::ponderStop = std::make_shared<std::atomic<bool>>(false);
+    CF::ponderActive = std::make_shared<std::atomic<bool>>(true);
+    CV::thinkingString = QString("Pondering on ") + QString(moveName(predictedReply).c_str());
+    CV::thinkingText->setPlainText(CV::thinkingString);
+
+    SearchLimits limits = getSearchLimits();
+    limits.stop = CF::ponderStop.get();
+    limits.ponder = CF::ponderActive.get();
+    limits.onIteration = [this](const SearchResult & progress){ //runs on the worker thread
+        QString text = QString("depth %1, %2 nodes").arg(progress.depth).arg(progress.nodes);
+        QMetaObject::invokeMethod(this, [this, text](){
+            if(ponderState == PonderRunning)
+                CV::thinkingText->setPlainText(CV::thinkingString + QString(": ") + text);
+            else if(ponderState == PonderHit)
+                CV::thinkingText->setPlainText(QString("Thinking: ") + text);
+        }, Qt::QueuedConnection);
+    };
+    std::shared_ptr<std::atomic<bool>> stop = CF::ponderStop; //keep the flags alive for as long as the search runs
+    std::shared_ptr<std::atomic<bool>> active = CF::ponderActive;
+    ponderWatcher.setFuture(QtConcurrent::run([position, side, limits, stop, active](){
+        return searchPosition(position, side, limits);
+    }));
+}
+void GameController::ponderFinished(){
+    if(ponderGameNumber != CV::gameNumber || ponderState == PonderNone)
+        return;
+    if(ponderState == PonderRunning){
+        ponderState = PonderFinished; //kept until the human moves
+        return;
+    }
+    ponderState = PonderNone;
+    CF::aiThinkingFlag = false;
+    CV::thinkingString = QString("");
+    CV::thinkingText->setPlainText(CV::thinkingString);
+    const SearchResult & result = ponderWatcher.result();
+    replyKnown = (result.pvLength >= 2);
+    if(replyKnown)
+        predictedReply = result.pv[1];
+    playAIMove(result.bestMove, result.stats); //the whole move, so its capture route is the one searched
+}
+//Cancels the ponder search and waits for it, so the next search doesn't start on the table while it still runs.
+//The search checks its stop flag every 1024 nodes, so the wait is short.
+void GameController::stopPondering(){
+    if(CF::ponderStop)
+        CF::ponderStop->store(true);
+    ponderState = PonderNone;
+    ponderWatcher.waitForFinished();
+}
+
+void GameController::moveFinished(int status){
+    if(status == WhiteWin || status == BlackWin || status == Draw)
+        emit gameEnded(status); //no more turns, so the AI isn't scheduled
+    else
+        emit moveCompleted(status);
+}
+//The game is over: nothing is left to ponder on, and the result is announced
+void GameController::endGame(int status){
+    stopPondering();
+    CV::thinkingString = QString("");
+    updateSceneText();
+    QMessageBox::information(nullptr, QString("Game over"), QString(CV::gameStateVector.at(status).c_str()));
+}
+void GameController::reset(){
+    if(CF::aiStop) //don't let the AI finish thinking about a game that is gone
+        CF::aiStop->store(true);
+    aiWatcher.waitForFinished(); //the cancelled search must be done before the next one starts on the same table
+    stopPondering();
+    replyKnown = false;
+    CF::aiThinkingFlag = false;
+    CV::gameNumber++;
+    CV::thinkingString = QString("");
+    CV::undoStack.clear();
+    CV::movesListLengths.clear();
+    switch(CV::boardLayout){
+    case Standard:
+        boardReset(CV::gameBoard);
+        break;
     }
-    drawSceneBoard(*scene);
+    checkCrown(CV::gameBoard);
+    CV::gameStatus = win(CV::gameBoard, CV::playerTurn);
+    CV::playerTurn = White;
+    CV::movesListString = QString("White\tBlack\n");
+    CV::movesListString2 = QString("White\tBlack\n");
+    drawScenePieces(*scene, CV::gameBoard); //the board, button and text items stay in the scene
+    updateSceneText();
+    emit gameReset();
+}
+//Takes back the last move, and the AI's moves before it, so that it is a human's turn again.
+//An AI search or ponder for the position being left is cancelled.
+void GameController::undo(){
+    if(CV::undoStack.empty())
+        return;
+    if(CF::aiStop)
+        CF::aiStop->store(true);
+    aiWatcher.waitForFinished(); //the cancelled search must be done before the next one starts on the same table
+    stopPondering();
+    replyKnown = false;
+    CF::aiThinkingFlag = false;
+    CV::gameNumber++;
+    CV::thinkingString = QString("");
+
+    const bool bothAI = CF::whiteAIFlag && CF::blackAIFlag;
+    Position position = toPosition(CV::gameBoard);
+    do{
+        unmakeMove(position, CV::undoStack);
+        CV::playerTurn = (CV::playerTurn == White) ? Black : White;
+        CV::movesListString.truncate(CV::movesListLengths.back().first);
+        CV::movesListString2.truncate(CV::movesListLengths.back().second);
+        CV::movesListLengths.pop_back();
+    }while(!bothAI && !CV::undoStack.empty()
+           && ((CV::playerTurn == White && CF::whiteAIFlag) || (CV::playerTurn == Black && CF::blackAIFlag)));
+    fromPosition(position, CV::gameBoard);
+    CV::gameStatus = win(position, CV::playerTurn);
+
     drawScenePieces(*scene, CV::gameBoard);
-    CF::playerMovingFlag = false;
+    updateSceneText();
+    QMetaObject::invokeMethod(this, &GameController::scheduleAI, Qt::QueuedConnection); //ponders, or plays if the AI is to move
+}
+//Starts the AI if the side to move is AI-controlled. If the human played the reply the AI was pondering on,
+//the ponder search carries on as the AI's move; otherwise it is stopped and the AI searches afresh, on the
+//transposition table the pondering warmed up. On the human's turn against the AI, pondering starts.
+void GameController::scheduleAI(){
+    if(CF::aiThinkingFlag || CV::gameStatus == WhiteWin || CV::gameStatus == BlackWin || CV::gameStatus == Draw)
+        return; //a finished game is handled by endGame
+    const bool aiTurn = (CV::playerTurn == White && CF::whiteAIFlag) || (CV::playerTurn == Black && CF::blackAIFlag);
+    const bool aiOpponent = (CV::playerTurn == White && CF::blackAIFlag) || (CV::playerTurn == Black && CF::whiteAIFlag);
+    if(aiTurn){
+        if(ponderState == PonderRunning || ponderState == PonderFinished){
+            Position position = toPosition(CV::gameBoard);
+            const bool hit = CV::playerTurn == ponderSide && position.black == ponderPosition.black
+                    && position.white == ponderPosition.white && position.kings == ponderPosition.kings;
+            std::cout<<(hit ? "Ponder hit" : "Ponder miss")<<std::endl;
+            if(hit && ponderState == PonderFinished){ //the answer is already there
+                ponderState = PonderHit;
+                ponderFinished();
+                return;
+            }
+            if(hit){
+                ponderState = PonderHit;
+                CF::aiThinkingFlag = true;
+                CF::ponderActive->store(false); //the search's own limits count from here
+                CV::thinkingString = QString("Thinking...");
+                CV::thinkingText->setPlainText(CV::thinkingString);
+                return;
+            }
+            stopPondering();
+        }
+        startAIMove(&aiWatcher);
+    }
+    else if(aiOpponent && ponderState == PonderNone)
+        startPondering();
 }
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    //AI search budget per move
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption depthOption("ai-depth", "Deepest iteration the AI searches to.", "plies", "64");
+    QCommandLineOption timeOption("ai-time", "Time the AI may think per move, 0 for no limit.", "ms", "1000");
+    QCommandLineOption nodesOption("ai-nodes", "Nodes the AI may search per move, 0 for no limit.", "nodes", "0");
+    QCommandLineOption hashOption("ai-hash", "Size of the AI's transposition table.", "MB", "32");
+    QCommandLineOption quiescenceOption("ai-quiescence", "Capture plies the AI plays out past its search depth, 0 for none.", "plies", "32");
+    QCommandLineOption noPonderOption("no-ai-ponder", "Don't let the AI think on the human's time.");
+    QCommandLineOption threadsOption("ai-threads", "Threads the AI searches with.", "threads", "1");
+    QCommandLineOption playersOption("ai-players", "Sides the AI plays: none, white, black or both.", "sides", "black");
+    QCommandLineOption traceOption("ai-trace", "Write a JSONL trace of every AI search to this file.", "file");
+    QCommandLineOption statsOption("ai-stats", "Add the statistics of every AI search to this file, one JSON object per line.", "file");
+    QCommandLineOption tablebaseOption("tablebase", "Directory of endgame tablebases made by checkers_tablebase.", "directory");
+    QCommandLineOption tablebaseCacheOption("tablebase-cache", "Memory for decompressed tablebase blocks.", "MB", "16");
+    QCommandLineOption bookOption("book", "Opening book made by checkers_book.", "file");
+    QCommandLineOption weightsOption("eval-weights", "Evaluation weights file, as written by checkers_tune.", "file");
+    parser.addOptions({depthOption, timeOption, nodesOption, quiescenceOption, noPonderOption, hashOption, threadsOption, playersOption, traceOption, statsOption, tablebaseOption, tablebaseCacheOption, bookOption, weightsOption});
+    parser.process(a);
+
+    QString aiPlayers = parser.value(playersOption);
+    CF::whiteAIFlag = (aiPlayers == "white" || aiPlayers == "both");
+    CF::blackAIFlag = (aiPlayers == "black" || aiPlayers == "both");
+    CF::ponderFlag = !parser.isSet(noPonderOption);
+
+    SearchLimits limits;
+    limits.maxDepth = parser.value(depthOption).toInt();
+    limits.timeMs = parser.value(timeOption).toInt();
+    limits.maxNodes = parser.value(nodesOption).toULongLong();
+    limits.quiescencePlies = parser.value(quiescenceOption).toInt();
+    limits.threads = parser.value(threadsOption).toInt();
+    setSearchLimits(limits);
+    sharedTranspositionTable().resize(parser.value(hashOption).toULongLong());
+    if(parser.isSet(traceOption) && !searchTrace().start(parser.value(traceOption).toStdString()))
+        std::cout<<"Could not open the trace file "<<parser.value(traceOption).toStdString()<<std::endl;
+    CV::statsFile = parser.value(statsOption).toStdString();
+    setTablebaseCache(parser.value(tablebaseCacheOption).toULongLong());
+    if(parser.isSet(tablebaseOption))
+        std::cout<<"Endgame tablebases loaded for up to "<<loadTablebases(parser.value(tablebaseOption).toStdString())<<" pieces"<<std::endl;
+    if(parser.isSet(weightsOption)){
+        EvalWeights weights;
+        if(readEvalWeights(parser.value(weightsOption).toStdString(), weights))
+            setEvalWeights(weights);
+        else
+            std::cout<<"Could not read the evaluation weights "<<parser.value(weightsOption).toStdString()<<std::endl;
+    }
+    if(parser.isSet(bookOption) && !loadOpeningBook(parser.value(bookOption).toStdString()))
+        std::cout<<"Could not load the opening book "<<parser.value(bookOption).toStdString()<<std::endl;
+
     int width = 1920;
     int height = 1080;
     QGraphicsScene scene(0,0, width, height);
@@ -192,33 +669,9 @@ int main(int argc, char *argv[])
     view.setWindowTitle("Checkers");
     view.showMaximized();
 
-    QTimer *timer = new QTimer;
-    QObject::connect(timer, &QTimer::timeout, [&scene](){
-        if(CF::resetFlag){
-            switch(CV::boardLayout){
-            case Standard:
-                boardReset(CV::gameBoard);
-                break;
-            }
-            checkCrown(CV::gameBoard);
-            CV::gameStatus = win(CV::gameBoard, CV::playerTurn);
-            CV::playerTurn = White;
-            scene.clear();
-            CV::movesListString = QString("White\tBlack\n");
-            CV::movesListString2 = QString("White\tBlack\n");
-            drawSceneBoard(scene);
-            drawScenePieces(scene, CV::gameBoard);
-            CF::resetFlag = false;
-        }
-        else if(!CF::playerMovingFlag && CV::gameStatus != WhiteWin && CV::gameStatus != BlackWin && CV::gameStatus != Draw){      
-            if(true && CV::playerTurn == Black){ //If it's Blacks's turn and an AI is controlling it
-                auto move = getMoveAI(CV::gameBoard, CV::playerTurn);
-                redrawBoard(move.first, move.second, &scene);
-            }
-        }
-
-    });
-    timer->start(100);
+    GameController controller(&scene);
+    CV::gameController = &controller;
+    controller.scheduleAI(); //in case White is AI-controlled
     view.show();
     return a.exec();
 }
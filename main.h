@@ -3,6 +3,9 @@
 #include <QApplication>
 #include <QGraphicsView>
 #include <QGraphicsSceneDragDropEvent>
+#include <QFutureWatcher>
+
+#include "BackTracking.h"
 
 namespace CV{static const std::vector<std::string> gameStateVector = {"Invalid Move", "" /*Valid Move*/, "White Wins", "Black Wins", "Draw", };}
 
@@ -36,9 +39,66 @@ private:
     }
 };
 
+typedef enum Ponder_State{
+    PonderNone = 0, //not pondering
+    PonderRunning,  //searching the position after the predicted reply while the human thinks
+    PonderFinished, //that search ended before the human moved, its result is kept in case the prediction is right
+    PonderHit       //the human played the predicted reply, the search now runs as the AI's move
+}Ponder_State;
+
+//Drives the turns from events rather than polling. Finished moves, resets and the end of the game
+//are signalled, and the AI is started straight from those signals when it is its turn.
+//During the human's turn the AI ponders: it searches the position after the reply it predicted.
+class GameController : public QObject
+{
+    Q_OBJECT
+public:
+    GameController(QGraphicsScene * scene, QObject * parent = nullptr);
+    void moveFinished(int status); //called once a move has been played on the board
+
+public slots:
+    void reset();
+    void undo(); //takes back moves until it is a human's turn
+    void scheduleAI();
+    void endGame(int status);
+
+signals:
+    void moveCompleted(int status);
+    void gameReset();
+    void gameEnded(int status);
+
+private:
+    void playAIMove(const Move & move, const SearchStats & stats);
+    void startPondering();
+    void stopPondering();
+    void ponderFinished();
+
+    QGraphicsScene * scene = nullptr;
+    QFutureWatcher<Move> aiWatcher;
+
+    QFutureWatcher<SearchResult> ponderWatcher;
+    int ponderState = PonderNone;
+    int ponderGameNumber = 0;
+    Position ponderPosition; //the position after the predicted reply
+    int ponderSide = White; //the AI's side, to move in ponderPosition
+    bool replyKnown = false; //whether the AI's last search predicted the human's reply
+    Move predictedReply;
+};
+
 void drawSceneBoard( QGraphicsScene & scene);
+void updateSceneText();
 void drawScenePieces(QGraphicsScene & scene, std::map<std::pair<char, char>, char> & gameBoard);
+void updateScenePieces(QGraphicsScene & scene,
+                       const std::map<std::pair<char, char>, char> & before,
+                       const std::map<std::pair<char, char>, char> & after,
+                       std::pair<char, char> from,
+                       std::pair<char, char> to);
+bool aiThinking(); //while the AI searches pieces can't be dragged, and drops are ignored
+void dragStarted();
+void dragFinished(); //pieces taken off the scene during the drag are freed once it is over
 void redrawBoard(std::pair<char, char> from, std::pair<char, char> to, QGraphicsScene * scene);
+void redrawBoard(const Move & move, QGraphicsScene * scene);
+void startAIMove(QFutureWatcher<Move> * aiWatcher);
 int main(int argc, char *argv[]);
 
 #endif
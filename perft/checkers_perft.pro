@@ -0,0 +1,15 @@
+#Headless perft benchmark for the move generator, built by ../Checkers.pro after the core library
+#Run with no arguments to check the known node counts, or --help for options.
+
+CONFIG -= qt
+
+TARGET = checkers_perft
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+
+CORE_BUILD_DIR = $$OUT_PWD/../core
+include(../core/checkers_core.pri)
+
+SOURCES += \
+        perft.cpp
@@ -0,0 +1,259 @@
+#include "Game.h"
+#include "BackTracking.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+//Leaf node counts used to check the move generator.
+//The initial position numbers are the published 8x8 checkers perft results. The other positions have no published
+//results; their counts were cross-checked against an independent mailbox move generator.
+struct PerftReference {
+    const char * name;
+    const char * fen;
+    std::vector<uint64_t> nodes; //nodes[i] is the count at depth i + 1
+};
+static const std::vector<PerftReference> references = {
+    { "boardReset", "W:W21-32:B1-12",
+      { 7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564, 85242128, 388623673 } },
+    { "customBoardEightPiecesEach", "W:W25-32:B1-8",
+      { 7, 49, 392, 3136, 26592, 218695, 1820189, 14532639 } },
+    { "kings and multi-jumps", "W:WK4,17,18,21,22,25,26,29:B5,6,9,10,13,14,K27,K28",
+      { 3, 8, 24, 99, 369, 1793, 7552, 41269, 174415, 973277, 4649249 } },
+};
+
+//Positions where capture sequences are easy to get wrong, with every sequence the side to move has.
+//Checked against the move generator and against the move validator the GUI uses.
+struct CaptureReference {
+    const char * name;
+    const char * fen;
+    std::vector<std::string> moves;
+};
+static const std::vector<CaptureReference> captureReferences = {
+    { "king loop back to its own square", "W:WK11:B15,14,6,7",
+      { "c3xe5xg3xe1xc3", "c3xe1xg3xe5xc3" } },
+    { "king loop through its own square", "W:WK11:B15,14,6,7,16",
+      { "c3xe5xg3xe1xc3xa5", "c3xa5", "c3xe1xg3xe5xc3xa5" } },
+    { "king loop through a landing square", "W:WK4:B8,15,14,6,7,16",
+      { "a1xc3xe5xg3xe1xc3xa5", "a1xc3xa5", "a1xc3xe1xg3xe5xc3xa5" } },
+    { "two routes to the same square", "B:W8,7,16,15,23:B3",
+      { "c1xe3xc5xe7", "c1xa3xc5xe7" } },
+    { "crowning ends the move", "B:W27,26:B24",
+      { "b6xd8" } },
+};
+
+//Checks the generated moves against the expected list, and that the validator plays the same moves.
+//When several sequences join the same squares the validator has to take the one that captures the most.
+static bool verifyCaptures(const CaptureReference & reference){
+    Position position;
+    int side = White;
+    readFen(reference.fen, position, side);
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+
+    std::vector<std::string> generated;
+    for (int i = 0; i < moveList.size; i++)
+        generated.push_back(moveName(moveList[i]));
+    std::vector<std::string> expected = reference.moves;
+    std::sort(generated.begin(), generated.end());
+    std::sort(expected.begin(), expected.end());
+    bool passed = (generated == expected);
+
+    for (int i = 0; i < moveList.size; i++) {
+        Position validated = position;
+        int turn = side;
+        std::streambuf * output = std::cout.rdbuf(nullptr); //the validator explains rejected moves on cout
+        int status = changeTurn(validated, std::make_pair(int(moveList[i].from), int(moveList[i].to)), turn);
+        std::cout.rdbuf(output);
+
+        int mostCaptured = 0;
+        bool matched = false;
+        for (int j = 0; j < moveList.size; j++) {
+            if (moveList[j].from == moveList[i].from && moveList[j].to == moveList[i].to)
+                mostCaptured = std::max(mostCaptured, bitCount(moveList[j].captured));
+        }
+        for (int j = 0; j < moveList.size; j++) {
+            Position played = position;
+            playMove(played, moveList[j]);
+            if (moveList[j].from == moveList[i].from && moveList[j].to == moveList[i].to
+                    && bitCount(moveList[j].captured) == mostCaptured && validated.black == played.black
+                    && validated.white == played.white && validated.kings == played.kings)
+                matched = true;
+        }
+        if (status == InvalidMove || !matched) {
+            std::cout << "    validator did not play " << moveName(moveList[i]) << std::endl;
+            passed = false;
+        }
+    }
+
+    std::cout << "  " << std::left << std::setw(40) << reference.name << std::right << (passed ? "ok" : "FAILED") << std::endl;
+    if (!passed) {
+        std::cout << "    expected:";
+        for (auto & name : expected)
+            std::cout << " " << name;
+        std::cout << std::endl << "    generated:";
+        for (auto & name : generated)
+            std::cout << " " << name;
+        std::cout << std::endl;
+    }
+    return passed;
+}
+
+static uint64_t moveListOverflows = 0; //positions whose moves didn't fit in a MoveList, any makes the counts wrong
+
+//Counts the leaf nodes of the move tree to the given depth. The position is walked with makeMove and
+//unmakeMove, so it is back as it was when this returns.
+static uint64_t perft(Position & position, const int & side, const int & depth, UndoStack & undo){
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+    if (moveList.overflowed)
+        moveListOverflows++;
+    if (depth <= 1)
+        return (depth == 1) ? moveList.size : 1;
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < moveList.size; i++) {
+        makeMove(position, moveList[i], undo);
+        nodes += perft(position, (side == Black) ? White : Black, depth - 1, undo);
+        unmakeMove(position, undo);
+    }
+    return nodes;
+}
+//Prints the leaf count under each root move
+static uint64_t divide(const Position & position, const int & side, const int & depth){
+    MoveList moveList;
+    generateMoves(position, side, moveList);
+    Position board = position;
+    UndoStack undo;
+    uint64_t total = 0;
+    for (int i = 0; i < moveList.size; i++) {
+        makeMove(board, moveList[i], undo);
+        uint64_t nodes = perft(board, (side == Black) ? White : Black, depth - 1, undo);
+        unmakeMove(board, undo);
+        std::cout << std::left << std::setw(24) << moveName(moveList[i]) << std::right << nodes << std::endl;
+        total += nodes;
+    }
+    std::cout << "Moves: " << moveList.size << "  Nodes: " << total << std::endl;
+    return total;
+}
+//Runs perft for each depth and prints nodes/sec. Returns false if a count doesn't match the expected one.
+static bool runPerft(const std::string & name, const Position & position, const int & side,
+                     const int & maxDepth, const std::vector<uint64_t> & expected){
+    bool passed = true;
+    std::cout << name << "  " << writeFen(position, side) << std::endl;
+    Position board = position;
+    UndoStack undo;
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(board, side, depth, undo);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::right << "  depth " << std::setw(2) << depth << std::setw(14) << nodes
+                  << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s"
+                  << std::setw(14) << uint64_t(seconds > 0 ? nodes / seconds : 0) << " nodes/s";
+        if (depth <= int(expected.size())) {
+            bool match = (nodes == expected.at(depth - 1));
+            std::cout << (match ? "  ok" : "  FAILED, expected ");
+            if (!match)
+                std::cout << expected.at(depth - 1);
+            passed = passed && match;
+        }
+        std::cout << std::endl;
+    }
+    //every move the tree made must have been taken back exactly
+    if (board.black != position.black || board.white != position.white || board.kings != position.kings
+            || board.hash != position.hash || board.hash != computeHash(board) || !undo.empty()) {
+        std::cout << "  FAILED, unmakeMove did not restore the position" << std::endl;
+        passed = false;
+    }
+    if (moveListOverflows > 0) {
+        std::cout << "  FAILED, " << moveListOverflows << " positions had more than " << MAX_MOVES << " moves" << std::endl;
+        moveListOverflows = 0;
+        passed = false;
+    }
+    return passed;
+}
+
+static void printUsage(){
+    std::cout << "Usage: checkers_perft [options]" << std::endl
+              << "  --depth N       search depth (default 9)" << std::endl
+              << "  --start NAME    start from boardReset or customBoardEightPiecesEach" << std::endl
+              << "  --fen FEN       start from a PDN FEN position, e.g. \"W:W21-32:B1-12\"" << std::endl
+              << "  --divide        print the node count under each root move" << std::endl
+              << "  --verify        check every reference position against its known counts, and the capture" << std::endl
+              << "                  sequences of the tricky capture positions (default)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int depth = 9;
+    bool divideMoves = false;
+    std::string fen;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc) {
+            depth = std::atoi(argv[++i]);
+        }
+        else if (arg == "--start" && i + 1 < argc) {
+            std::string start = argv[++i];
+            if (start == "boardReset")
+                fen = references.at(0).fen;
+            else if (start == "customBoardEightPiecesEach")
+                fen = references.at(1).fen;
+            else {
+                std::cout << "Unknown start position: " << start << std::endl;
+                return 2;
+            }
+        }
+        else if (arg == "--fen" && i + 1 < argc) {
+            fen = argv[++i];
+        }
+        else if (arg == "--divide") {
+            divideMoves = true;
+        }
+        else if (arg == "--verify") {
+            fen.clear();
+        }
+        else {
+            printUsage();
+            return (arg == "--help") ? 0 : 2;
+        }
+    }
+
+    if (fen.empty()) { //verify every reference position
+        bool passed = true;
+        for (auto & reference : references) {
+            Position position;
+            int side = White;
+            readFen(reference.fen, position, side);
+            passed = runPerft(reference.name, position, side, std::min<int>(depth, reference.nodes.size()), reference.nodes) && passed;
+        }
+        std::cout << "capture sequences" << std::endl;
+        for (auto & reference : captureReferences)
+            passed = verifyCaptures(reference) && passed;
+        std::cout << (passed ? "All perft counts and capture sequences match." : "Perft counts or capture sequences do not match!") << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    Position position;
+    int side = White;
+    if (!readFen(fen, position, side)) {
+        std::cout << "Invalid FEN: " << fen << std::endl;
+        return 2;
+    }
+    if (divideMoves) {
+        divide(position, side, depth);
+        return 0;
+    }
+    std::vector<uint64_t> expected;
+    for (auto & reference : references) {
+        Position referencePosition;
+        int referenceSide = White;
+        readFen(reference.fen, referencePosition, referenceSide);
+        if (referenceSide == side && referencePosition.black == position.black
+                && referencePosition.white == position.white && referencePosition.kings == position.kings)
+            expected = reference.nodes;
+    }
+    return runPerft("perft", position, side, depth, expected) ? 0 : 1;
+}
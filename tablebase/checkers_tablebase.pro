@@ -0,0 +1,15 @@
+#Endgame tablebase generator, built by ../Checkers.pro after the core library
+#Run with --help for options. The GUI loads the tables with --tablebase <directory>.
+
+CONFIG -= qt
+
+TARGET = checkers_tablebase
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+
+CORE_BUILD_DIR = $$OUT_PWD/../core
+include(../core/checkers_core.pri)
+
+SOURCES += \
+        tablebase.cpp
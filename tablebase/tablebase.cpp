@@ -0,0 +1,54 @@
+#include "Game.h"
+#include "Tablebase.h"
+
+#include <chrono>
+#include <thread>
+
+static void printUsage(){
+    std::cout << "Usage: checkers_tablebase [options]" << std::endl
+              << "  --pieces N      solve every table with up to N pieces (default 4)" << std::endl
+              << "  --threads N     threads to solve with (default: all cores)" << std::endl
+              << "  --dir PATH      directory to write the tables to (default tablebases)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int pieces = 4;
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    std::string directory = "tablebases";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--pieces" && i + 1 < argc)
+            pieces = std::atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::atoi(argv[++i]);
+        else if (arg == "--dir" && i + 1 < argc)
+            directory = argv[++i];
+        else {
+            printUsage();
+            return (arg == "--help") ? 0 : 2;
+        }
+    }
+    if (pieces < 2 || pieces > TB_MAX_PIECES) {
+        std::cout << "--pieces must be between 2 and " << TB_MAX_PIECES << std::endl;
+        return 2;
+    }
+
+    std::cout << "Solving tables with up to " << pieces << " pieces on " << threads << " threads into " << directory << std::endl;
+    std::cout << std::setw(14) << "table" << std::setw(14) << "positions" << std::setw(12) << "wins"
+              << std::setw(12) << "losses" << std::setw(12) << "draws" << std::setw(12) << "bytes" << std::setw(10) << "ms" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    bool written = generateTablebases(directory, pieces, threads,
+                                      [](const TablebaseSlice & slice, const TablebaseCounts & counts, const int & ms){
+        std::cout << std::setw(14) << tablebaseFileName(slice) << std::setw(14) << tablebaseSize(slice)
+                  << std::setw(12) << counts.wins << std::setw(12) << counts.losses << std::setw(12) << counts.draws
+                  << std::setw(12) << counts.bytes << std::setw(10) << ms << std::endl;
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!written) {
+        std::cout << "Could not write the tables to " << directory << std::endl;
+        return 1;
+    }
+    std::cout << "Done in " << std::fixed << std::setprecision(1) << seconds << " s" << std::endl;
+    return 0;
+}
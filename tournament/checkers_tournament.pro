@@ -0,0 +1,15 @@
+#Headless engine-vs-engine tournaments, built by ../Checkers.pro after the core library
+#Run with --help for options.
+
+CONFIG -= qt
+
+TARGET = checkers_tournament
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+
+CORE_BUILD_DIR = $$OUT_PWD/../core
+include(../core/checkers_core.pri)
+
+SOURCES += \
+        tournament.cpp
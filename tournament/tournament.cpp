@@ -0,0 +1,337 @@
+#include "Game.h"
+#include "BackTracking.h"
+#include "Evaluate.h"
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+//One side of the match. Engines differ only in how they search.
+struct Engine {
+    std::string name;
+    SearchLimits limits;
+    EvalWeights weights;
+    int slowestMoveMs = 0;
+};
+
+struct Opening {
+    Position position;
+    int side = White;
+};
+
+//Wins, draws and losses of engine A
+struct MatchScore {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    int games() const{
+        return wins + draws + losses;
+    }
+    double score() const{
+        return games() > 0 ? (wins + 0.5 * draws) / games() : 0.5;
+    }
+    //Variance of the score of one game
+    double variance() const{
+        const double s = score();
+        return games() > 0 ? (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / games() : 0.0;
+    }
+};
+
+static double eloToScore(const double & elo){
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+static double scoreToElo(const double & score){
+    const double clamped = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / clamped - 1.0);
+}
+//Log-likelihood ratio of elo1 against elo0, using the normal approximation to the game results
+static double sprtLlr(const MatchScore & match, const double & elo0, const double & elo1){
+    const double variance = match.variance();
+    if (match.games() == 0 || variance <= 0)
+        return 0.0;
+    const double s0 = eloToScore(elo0);
+    const double s1 = eloToScore(elo1);
+    return match.games() * (s1 - s0) * (2 * match.score() - s0 - s1) / (2 * variance);
+}
+
+static void printScore(const MatchScore & match, const Engine & a, const Engine & b){
+    const double margin = 1.96 * std::sqrt(match.variance() / std::max(1, match.games()));
+    const double elo = scoreToElo(match.score());
+    std::cout << a.name << " vs " << b.name << ": " << match.games() << " games, +" << match.wins << " =" << match.draws
+              << " -" << match.losses << ", score " << std::fixed << std::setprecision(1) << 100.0 * match.score() << "%, Elo "
+              << std::showpos << elo << std::noshowpos << " +/- " << (scoreToElo(match.score() + margin) - elo) << std::endl;
+}
+
+//Plays one game and returns WhiteWin, BlackWin or Draw. A position seen for the third time since the last
+//man move or capture is a draw, and so is a game still going after maxPlies.
+//The positions the engines moved from are added to 'played'.
+static int playGame(const Opening & opening, Engine * whiteEngine, Engine * blackEngine,
+                    TranspositionTable & whiteTable, TranspositionTable & blackTable, const int & maxPlies,
+                    std::vector<std::string> & played){
+    Position position = opening.position;
+    int side = opening.side;
+    std::vector<uint64_t> history; //keys since the last move that can't be undone
+    whiteTable.clear();
+    blackTable.clear();
+    for (int ply = 0; ply < maxPlies; ply++) {
+        int state = win(position, side);
+        if (state != ValidMove)
+            return state;
+        const uint64_t key = positionKey(position, side);
+        if (std::count(history.begin(), history.end(), key) >= 2)
+            return Draw;
+        history.push_back(key);
+        played.push_back(writeFen(position, side));
+
+        Engine * engine = (side == White) ? whiteEngine : blackEngine;
+        auto start = std::chrono::steady_clock::now();
+        Move move = searchPosition(position, side, engine->limits, (side == White) ? &whiteTable : &blackTable).bestMove;
+        int ms = int(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+        engine->slowestMoveMs = std::max(engine->slowestMoveMs, ms); //only read once the workers have finished
+
+        if (move.jumps > 0 || !(position.kings & squareMask(move.from)))
+            history.clear();
+        playMove(position, move);
+        side = (side == White) ? Black : White;
+    }
+    return Draw;
+}
+
+//Openings: "start", "eight" (customBoardEightPiecesEach) or a file with one FEN per line
+static bool readOpenings(const std::string & source, std::vector<Opening> & openings){
+    Opening opening;
+    if (source == "start") {
+        boardReset(opening.position);
+        openings.push_back(opening);
+        return true;
+    }
+    if (source == "eight") {
+        customBoardEightPiecesEach(opening.position);
+        openings.push_back(opening);
+        return true;
+    }
+    std::ifstream file(source);
+    if (!file)
+        return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line.at(0) == '#')
+            continue;
+        if (!readFen(line, opening.position, opening.side)) {
+            std::cout << "Skipping unreadable opening " << line << std::endl;
+            continue;
+        }
+        openings.push_back(opening);
+    }
+    return !openings.empty();
+}
+
+//Plays random moves from the opening so that repeated games differ. False if the game ended on the way.
+static bool randomiseOpening(Opening & opening, const int & plies, std::mt19937 & random){
+    for (int ply = 0; ply < plies; ply++) {
+        MoveList moveList;
+        generateMoves(opening.position, opening.side, moveList);
+        if (moveList.size == 0)
+            return false;
+        playMove(opening.position, moveList[std::uniform_int_distribution<int>(0, moveList.size - 1)(random)]);
+        opening.side = (opening.side == White) ? Black : White;
+    }
+    return win(opening.position, opening.side) == ValidMove;
+}
+
+static void printUsage(){
+    std::cout << "Usage: checkers_tournament [options]" << std::endl
+              << "  --games N            games to play, in pairs with colours swapped (default 100)" << std::endl
+              << "  --concurrency N      games played at once (default: all cores)" << std::endl
+              << "  --openings SRC       start, eight, or a file with one FEN per line (default start)" << std::endl
+              << "  --random-plies N     random moves played from each opening before the pair starts (default 4)" << std::endl
+              << "  --max-plies N        games still going after N plies are draws (default 300)" << std::endl
+              << "  --time MS            time per move for both engines (default 100)" << std::endl
+              << "  --time-a/--time-b MS, --depth-a/--depth-b N, --nodes-a/--nodes-b N" << std::endl
+              << "                       per-engine limits, 0 for none (depth default 64)" << std::endl
+              << "  --weights-a/--weights-b FILE  per-engine evaluation weights" << std::endl
+              << "  --qsearch-a/--qsearch-b N     per-engine quiescence plies, 0 to evaluate at the horizon (default 32)" << std::endl
+              << "  --hash MB            transposition table of each engine in each game (default 16)" << std::endl
+              << "  --tablebase DIR      adjudicate and search with endgame tablebases" << std::endl
+              << "  --elo0 E --elo1 E    SPRT hypotheses for A's Elo over B (default 0 and 10)" << std::endl
+              << "  --alpha P --beta P   SPRT error rates (default 0.05)" << std::endl
+              << "  --sprt               stop as soon as the SPRT accepts either hypothesis" << std::endl
+              << "  --seed N             seed for the random opening moves (default 1)" << std::endl
+              << "  --positions FILE     write every position played, with White's score in the game, for checkers_tune" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int games = 100;
+    int concurrency = std::max(1, int(std::thread::hardware_concurrency()));
+    std::string openingSource = "start";
+    int randomPlies = 4;
+    int maxPlies = 300;
+    size_t hashMb = 16;
+    double elo0 = 0;
+    double elo1 = 10;
+    double alpha = 0.05;
+    double beta = 0.05;
+    bool stopOnSprt = false;
+    unsigned int seed = 1;
+    std::ofstream positionsFile;
+    Engine engines[2];
+    engines[0].name = "A";
+    engines[1].name = "B";
+    for (auto & engine : engines) {
+        engine.limits.timeMs = 100;
+        engine.limits.threads = 1; //games run side by side instead
+    }
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        int engine = (arg.size() > 2 && arg.compare(arg.size() - 2, 2, "-b") == 0) ? 1 : 0;
+        if (arg == "--games" && hasValue)
+            games = std::atoi(argv[++i]);
+        else if (arg == "--concurrency" && hasValue)
+            concurrency = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--openings" && hasValue)
+            openingSource = argv[++i];
+        else if (arg == "--random-plies" && hasValue)
+            randomPlies = std::atoi(argv[++i]);
+        else if (arg == "--max-plies" && hasValue)
+            maxPlies = std::atoi(argv[++i]);
+        else if (arg == "--time" && hasValue)
+            engines[0].limits.timeMs = engines[1].limits.timeMs = std::atoi(argv[++i]);
+        else if ((arg == "--time-a" || arg == "--time-b") && hasValue)
+            engines[engine].limits.timeMs = std::atoi(argv[++i]);
+        else if ((arg == "--depth-a" || arg == "--depth-b") && hasValue)
+            engines[engine].limits.maxDepth = std::atoi(argv[++i]);
+        else if ((arg == "--nodes-a" || arg == "--nodes-b") && hasValue)
+            engines[engine].limits.maxNodes = std::strtoull(argv[++i], nullptr, 10);
+        else if ((arg == "--qsearch-a" || arg == "--qsearch-b") && hasValue)
+            engines[engine].limits.quiescencePlies = std::atoi(argv[++i]);
+        else if ((arg == "--weights-a" || arg == "--weights-b") && hasValue) {
+            if (!readEvalWeights(argv[++i], engines[engine].weights)) {
+                std::cout << "Could not read the evaluation weights " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--hash" && hasValue)
+            hashMb = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--tablebase" && hasValue)
+            std::cout << "Endgame tablebases loaded for up to " << loadTablebases(argv[++i]) << " pieces" << std::endl;
+        else if (arg == "--elo0" && hasValue)
+            elo0 = std::atof(argv[++i]);
+        else if (arg == "--elo1" && hasValue)
+            elo1 = std::atof(argv[++i]);
+        else if (arg == "--alpha" && hasValue)
+            alpha = std::atof(argv[++i]);
+        else if (arg == "--beta" && hasValue)
+            beta = std::atof(argv[++i]);
+        else if (arg == "--sprt")
+            stopOnSprt = true;
+        else if (arg == "--seed" && hasValue)
+            seed = unsigned(std::atoi(argv[++i]));
+        else if (arg == "--positions" && hasValue) {
+            positionsFile.open(argv[++i], std::ios::trunc);
+            if (!positionsFile) {
+                std::cout << "Could not open " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else {
+            printUsage();
+            return (arg == "--help") ? 0 : 2;
+        }
+    }
+    for (auto & engine : engines) {
+        if (engine.limits.maxDepth <= 0 || engine.limits.maxDepth > MAX_PLY - 1)
+            engine.limits.maxDepth = MAX_PLY - 1;
+        if (engine.limits.timeMs == 0 && engine.limits.maxNodes == 0 && engine.limits.maxDepth == MAX_PLY - 1) {
+            std::cout << "Engine " << engine.name << " needs a time, depth or node limit" << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<Opening> openings;
+    if (!readOpenings(openingSource, openings)) {
+        std::cout << "Could not read openings from " << openingSource << std::endl;
+        return 1;
+    }
+    const int pairs = std::max(1, (games + 1) / 2);
+    const double lowerBound = std::log(beta / (1 - alpha));
+    const double upperBound = std::log((1 - beta) / alpha);
+    std::cout << "Playing " << 2 * pairs << " games, " << concurrency << " at a time, from " << openings.size()
+              << " opening(s). SPRT elo0 " << elo0 << " elo1 " << elo1 << ", bounds [" << std::setprecision(2)
+              << lowerBound << ", " << upperBound << "]" << std::endl;
+
+    //Each worker takes the next pair, picks its opening and plays it once with each colour
+    std::atomic<int> nextPair{0};
+    std::atomic<bool> stop{false};
+    std::mutex scoreMutex;
+    MatchScore match;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < concurrency; t++) {
+        workers.emplace_back([&](){
+            TranspositionTable tables[2] = { TranspositionTable(hashMb), TranspositionTable(hashMb) };
+            std::vector<std::string> played;
+            Engine local[2] = { engines[0], engines[1] };
+            for (auto & engine : local)
+                engine.limits.weights = &engine.weights;
+            for (int pair = nextPair++; pair < pairs && !stop; pair = nextPair++) {
+                std::mt19937 random(seed * 7919 + pair); //the same openings whatever the concurrency
+                Opening opening = openings.at(pair % openings.size());
+                if (!randomiseOpening(opening, randomPlies, random))
+                    opening = openings.at(pair % openings.size());
+
+                for (int round = 0; round < 2 && !stop; round++) {
+                    const int aColour = (round == 0) ? White : Black;
+                    Engine * whiteEngine = &local[(aColour == White) ? 0 : 1];
+                    Engine * blackEngine = &local[(aColour == White) ? 1 : 0];
+                    played.clear();
+                    int result = playGame(opening, whiteEngine, blackEngine, tables[0], tables[1], maxPlies, played);
+
+                    std::lock_guard<std::mutex> lock(scoreMutex);
+                    if (positionsFile.is_open()) {
+                        const char * whiteScore = (result == WhiteWin) ? "1" : (result == BlackWin) ? "0" : "0.5";
+                        for (auto & fen : played)
+                            positionsFile << fen << " " << whiteScore << "\n";
+                    }
+                    if (result == Draw)
+                        match.draws++;
+                    else if ((result == WhiteWin) == (aColour == White))
+                        match.wins++;
+                    else
+                        match.losses++;
+                    const double llr = sprtLlr(match, elo0, elo1);
+                    if (match.games() % 20 == 0) {
+                        printScore(match, engines[0], engines[1]);
+                        std::cout << "  LLR " << std::setprecision(2) << llr << std::endl;
+                    }
+                    if (stopOnSprt && (llr <= lowerBound || llr >= upperBound))
+                        stop = true;
+                }
+            }
+            std::lock_guard<std::mutex> lock(scoreMutex);
+            for (int i = 0; i < 2; i++)
+                engines[i].slowestMoveMs = std::max(engines[i].slowestMoveMs, local[i].slowestMoveMs);
+        });
+    }
+    for (auto & worker : workers)
+        worker.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double llr = sprtLlr(match, elo0, elo1);
+    std::cout << std::endl << "Finished in " << std::fixed << std::setprecision(1) << seconds << " s" << std::endl;
+    printScore(match, engines[0], engines[1]);
+    std::cout << "SPRT: LLR " << std::setprecision(2) << llr << " [" << lowerBound << ", " << upperBound << "] - "
+              << ((llr >= upperBound) ? "H1 accepted" : (llr <= lowerBound) ? "H0 accepted" : "inconclusive") << std::endl;
+    for (auto & engine : engines)
+        std::cout << "Slowest move of " << engine.name << ": " << engine.slowestMoveMs << " ms" << std::endl;
+    return 0;
+}
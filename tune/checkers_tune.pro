@@ -0,0 +1,15 @@
+#Evaluation weight tuner, built by ../Checkers.pro after the core library
+#Run with --help for options. The GUI loads the weights with --eval-weights <file>.
+
+CONFIG -= qt
+
+TARGET = checkers_tune
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+
+CORE_BUILD_DIR = $$OUT_PWD/../core
+include(../core/checkers_core.pri)
+
+SOURCES += \
+        tune.cpp
@@ -0,0 +1,258 @@
+#include "Game.h"
+#include "Evaluate.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+//Texel tuning: the evaluation, passed through a logistic curve, predicts the game result, and the weights are
+//moved down the gradient of the log loss of that prediction. The evaluation is linear in the weights, so the
+//gradient of each weight is just (prediction - result) times its term.
+
+//One labelled position, reduced to its evaluation terms from White's side
+struct Sample {
+    int16_t features[EVAL_TERMS];
+    float result; //White's score: 1, 0.5 or 0
+};
+
+static bool readResult(const std::string & token, float & result){
+    if (token == "1" || token == "1.0" || token == "1-0")
+        result = 1.0f;
+    else if (token == "0" || token == "0.0" || token == "0-1")
+        result = 0.0f;
+    else if (token == "0.5" || token == "1/2-1/2")
+        result = 0.5f;
+    else
+        return false;
+    return true;
+}
+
+//Reads up to maxSamples lines of "FEN result". Positions where the side to move has to capture aren't quiet,
+//their evaluation says little about the result, so they are skipped. Returns false at the end of the file.
+static bool readChunk(std::istream & input, std::vector<Sample> & samples, const size_t & maxSamples, uint64_t & skipped){
+    samples.clear();
+    std::string line;
+    while (samples.size() < maxSamples && std::getline(input, line)) {
+        std::istringstream fields(line);
+        std::string fen;
+        std::string token;
+        Sample sample;
+        Position position;
+        int side = White;
+        if (!(fields >> fen >> token) || !readResult(token, sample.result) || !readFen(fen, position, side)) {
+            skipped++;
+            continue;
+        }
+        MoveList moveList;
+        generateMoves(position, side, moveList);
+        if (moveList.size == 0 || moveList[0].jumps > 0) {
+            skipped++;
+            continue;
+        }
+        int features[EVAL_TERMS];
+        evalFeatures(position, White, features);
+        for (int term = 0; term < EVAL_TERMS; term++)
+            sample.features[term] = int16_t(features[term]);
+        samples.push_back(sample);
+    }
+    return !samples.empty();
+}
+
+//Predicted White score for an evaluation, k scales evaluations to the logistic curve
+static double predict(const double & evaluation, const double & k){
+    return 1.0 / (1.0 + std::pow(10.0, -k * evaluation / 400.0));
+}
+static double evaluation(const Sample & sample, const double * weights){
+    double score = 0;
+    for (int term = 0; term < EVAL_TERMS; term++)
+        score += weights[term] * sample.features[term];
+    return score;
+}
+//Log loss of the samples, and its gradient added to 'gradient' when it isn't null
+static double lossAndGradient(const Sample * begin, const Sample * end, const double * weights,
+                              const double & k, double * gradient){
+    const double slope = k * std::log(10.0) / 400.0; //d(logit)/d(evaluation)
+    double loss = 0;
+    for (const Sample * sample = begin; sample != end; sample++) {
+        const double p = std::min(std::max(predict(evaluation(*sample, weights), k), 1e-9), 1.0 - 1e-9);
+        loss -= sample->result * std::log(p) + (1.0 - sample->result) * std::log(1.0 - p);
+        if (gradient != nullptr) {
+            const double error = (p - sample->result) * slope;
+            for (int term = 0; term < EVAL_TERMS; term++)
+                gradient[term] += error * sample->features[term];
+        }
+    }
+    return loss;
+}
+//The same split over threads, each taking one slice of the samples
+static double parallelLossAndGradient(const std::vector<Sample> & samples, const size_t & first, const size_t & count,
+                                      const double * weights, const double & k, double * gradient, const int & threads){
+    std::vector<double> losses(threads, 0.0);
+    std::vector<std::vector<double>> gradients(threads, std::vector<double>(EVAL_TERMS, 0.0));
+    std::vector<std::thread> workers;
+    const size_t slice = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; t++) {
+        const size_t begin = first + std::min(count, t * slice);
+        const size_t end = first + std::min(count, (t + 1) * slice);
+        workers.emplace_back([&, t, begin, end](){
+            losses.at(t) = lossAndGradient(samples.data() + begin, samples.data() + end, weights, k,
+                                           (gradient != nullptr) ? gradients.at(t).data() : nullptr);
+        });
+    }
+    double loss = 0;
+    for (int t = 0; t < threads; t++) {
+        workers.at(t).join();
+        loss += losses.at(t);
+        if (gradient != nullptr)
+            for (int term = 0; term < EVAL_TERMS; term++)
+                gradient[term] += gradients.at(t).at(term);
+    }
+    return loss;
+}
+
+//The k that best fits the starting weights to the results, by ternary search on the mean loss
+static double fitK(const std::vector<Sample> & samples, const double * weights, const int & threads){
+    double low = 0.01;
+    double high = 5.0;
+    for (int i = 0; i < 60; i++) {
+        const double a = low + (high - low) / 3;
+        const double b = high - (high - low) / 3;
+        if (parallelLossAndGradient(samples, 0, samples.size(), weights, a, nullptr, threads)
+                < parallelLossAndGradient(samples, 0, samples.size(), weights, b, nullptr, threads))
+            high = b;
+        else
+            low = a;
+    }
+    return (low + high) / 2;
+}
+
+static void printUsage(){
+    std::cout << "Usage: checkers_tune --data FILE [options]" << std::endl
+              << "  --data FILE       positions, one \"FEN result\" per line, result 1, 0.5 or 0 for White" << std::endl
+              << "                    (checkers_tournament --positions writes these)" << std::endl
+              << "  --weights FILE    weights to start from (default: the built in ones)" << std::endl
+              << "  --out FILE        weights file to write (default weights.txt)" << std::endl
+              << "  --epochs N        passes over the data (default 20)" << std::endl
+              << "  --batch N         positions per gradient step (default 16384)" << std::endl
+              << "  --chunk N         positions held in memory at once (default 1000000)" << std::endl
+              << "  --rate R          Adam step size, in weight points (default 1)" << std::endl
+              << "  --k K             logistic scale (default: fitted to the starting weights)" << std::endl
+              << "  --threads N       threads the gradient is split over (default: all cores)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string dataPath;
+    std::string weightsPath;
+    std::string outputPath = "weights.txt";
+    int epochs = 20;
+    size_t batchSize = 16384;
+    size_t chunkSize = 1000000;
+    double rate = 1.0;
+    double k = 0;
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc)
+            dataPath = argv[++i];
+        else if (arg == "--weights" && i + 1 < argc)
+            weightsPath = argv[++i];
+        else if (arg == "--out" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (arg == "--epochs" && i + 1 < argc)
+            epochs = std::atoi(argv[++i]);
+        else if (arg == "--batch" && i + 1 < argc)
+            batchSize = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--chunk" && i + 1 < argc)
+            chunkSize = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--rate" && i + 1 < argc)
+            rate = std::atof(argv[++i]);
+        else if (arg == "--k" && i + 1 < argc)
+            k = std::atof(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else {
+            printUsage();
+            return (arg == "--help") ? 0 : 2;
+        }
+    }
+    if (dataPath.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    EvalWeights start;
+    if (!weightsPath.empty() && !readEvalWeights(weightsPath, start)) {
+        std::cout << "Could not read the weights " << weightsPath << std::endl;
+        return 1;
+    }
+    double weights[EVAL_TERMS];
+    for (int term = 0; term < EVAL_TERMS; term++)
+        weights[term] = start.weight[term];
+
+    std::ifstream data(dataPath);
+    if (!data) {
+        std::cout << "Could not open " << dataPath << std::endl;
+        return 1;
+    }
+    std::vector<Sample> samples;
+    samples.reserve(chunkSize);
+    uint64_t skipped = 0;
+    if (k <= 0) {
+        if (!readChunk(data, samples, chunkSize, skipped)) {
+            std::cout << "No usable positions in " << dataPath << std::endl;
+            return 1;
+        }
+        k = fitK(samples, weights, threads);
+        std::cout << "Fitted k = " << std::fixed << std::setprecision(4) << k << " on " << samples.size() << " positions" << std::endl;
+    }
+
+    //Adam: each weight steps by about 'rate' at most, scaled by its own gradient history
+    const double beta1 = 0.9;
+    const double beta2 = 0.999;
+    double moment[EVAL_TERMS] = {};
+    double velocity[EVAL_TERMS] = {};
+    uint64_t step = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        data.clear();
+        data.seekg(0);
+        skipped = 0;
+        double totalLoss = 0;
+        uint64_t positions = 0;
+        while (readChunk(data, samples, chunkSize, skipped)) {
+            for (size_t first = 0; first < samples.size(); first += batchSize) {
+                const size_t count = std::min(batchSize, samples.size() - first);
+                double gradient[EVAL_TERMS] = {};
+                totalLoss += parallelLossAndGradient(samples, first, count, weights, k, gradient, threads);
+                positions += count;
+                step++;
+                for (int term = 0; term < EVAL_TERMS; term++) {
+                    const double g = gradient[term] / count;
+                    moment[term] = beta1 * moment[term] + (1 - beta1) * g;
+                    velocity[term] = beta2 * velocity[term] + (1 - beta2) * g * g;
+                    const double corrected = moment[term] / (1 - std::pow(beta1, double(step)));
+                    const double scale = velocity[term] / (1 - std::pow(beta2, double(step)));
+                    weights[term] -= rate * corrected / (std::sqrt(scale) + 1e-12);
+                }
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "epoch " << std::setw(3) << epoch << "  loss " << std::fixed << std::setprecision(6)
+                  << totalLoss / std::max<uint64_t>(1, positions) << "  positions " << positions << "  skipped " << skipped
+                  << "  " << std::setprecision(1) << seconds << " s" << std::endl;
+    }
+
+    EvalWeights tuned;
+    for (int term = 0; term < EVAL_TERMS; term++) {
+        tuned.weight[term] = int(std::lround(weights[term]));
+        std::cout << std::setw(12) << evalTermName(term) << std::setw(8) << start.weight[term] << " -> " << tuned.weight[term] << std::endl;
+    }
+    if (!writeEvalWeights(outputPath, tuned)) {
+        std::cout << "Could not write " << outputPath << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << outputPath << std::endl;
+    return 0;
+}